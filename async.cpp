@@ -0,0 +1,181 @@
+#include "bigint_multiply.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "parlaylib/include/parlay/parallel.h"
+
+#include "bigint_cancel.h"
+
+using BigInt = std::vector<long long>;
+using clock_type = std::chrono::steady_clock;
+
+struct cancellation_token::state {
+    std::atomic<bool> flag{false};
+    bool has_deadline = false;
+    clock_type::time_point deadline;
+};
+
+cancellation_token::cancellation_token() : shared(std::make_shared<state>()) {}
+
+cancellation_token::cancellation_token(clock_type::time_point deadline) : shared(std::make_shared<state>()) {
+    shared->has_deadline = true;
+    shared->deadline = deadline;
+}
+
+cancellation_token cancellation_token::with_timeout(clock_type::duration timeout) {
+    return cancellation_token(clock_type::now() + timeout);
+}
+
+void cancellation_token::cancel() const {
+    shared->flag.store(true, std::memory_order_relaxed);
+}
+
+bool cancellation_token::cancelled() const {
+    if (shared->flag.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    return shared->has_deadline && clock_type::now() >= shared->deadline;
+}
+
+const cancellation_token*& cancellation_current() {
+    static thread_local const cancellation_token* token = nullptr;
+    return token;
+}
+
+// One queued product. run does the work and fulfils the promise; fail
+// completes it with multiply_cancelled instead.
+struct async_request {
+    double cost;
+    cancellation_token token;
+    std::function<void()> run;
+    std::function<void()> fail;
+};
+
+// A background thread that owns the parlay scheduler all asynchronous
+// products share. Whenever requests are pending it starts one task per
+// worker. Each task repeatedly takes the largest pending request, as
+// multiply_batch does, so requests that arrive while others run are picked
+// up as soon as a worker frees. Expired or cancelled requests are dropped
+// when taken, before any work is done.
+class async_pool {
+public:
+    static async_pool& instance() {
+        static async_pool pool;
+        return pool;
+    }
+
+    void submit(async_request request) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.push_back(std::move(request));
+        }
+        wake.notify_one();
+    }
+
+    ~async_pool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        dispatcher.join();
+    }
+
+private:
+    async_pool() : dispatcher([this] { dispatch(); }) {}
+
+    std::optional<async_request> take() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pending.empty() || stopping) {
+            return std::nullopt;
+        }
+        auto largest = std::max_element(pending.begin(), pending.end(),
+                                        [](const async_request& a, const async_request& b) { return a.cost < b.cost; });
+        async_request request = std::move(*largest);
+        pending.erase(largest);
+        return request;
+    }
+
+    static void execute(async_request& request) {
+        if (request.token.cancelled()) {
+            request.fail();
+            return;
+        }
+        cancellation_scope scope(&request.token);
+        request.run();
+    }
+
+    void dispatch() {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || !pending.empty(); });
+                if (stopping) {
+                    for (auto& request : pending) {
+                        request.fail();
+                    }
+                    pending.clear();
+                    return;
+                }
+            }
+            parlay::parallel_for(0, parlay::num_workers(), [&](size_t) {
+                while (auto request = take()) {
+                    execute(*request);
+                }
+            }, 1);
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<async_request> pending;
+    bool stopping = false;
+    std::thread dispatcher;
+};
+
+// Queues compute(), whose result is discarded if the token fired while it
+// ran, since a cancelled kernel returns zeros rather than the product.
+template <typename T, typename F>
+static std::future<T> submit(double cost, cancellation_token token, F compute) {
+    auto promise = std::make_shared<std::promise<T>>();
+    std::future<T> future = promise->get_future();
+
+    async_request request;
+    request.cost = cost;
+    request.token = token;
+    request.fail = [promise] { promise->set_exception(std::make_exception_ptr(multiply_cancelled())); };
+    request.run = [promise, token, compute = std::move(compute)]() mutable {
+        try {
+            T result = compute();
+            if (token.cancelled()) {
+                promise->set_exception(std::make_exception_ptr(multiply_cancelled()));
+            } else {
+                promise->set_value(std::move(result));
+            }
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+        }
+    };
+    async_pool::instance().submit(std::move(request));
+    return future;
+}
+
+std::future<BigInt> async_multiply(BigInt a, BigInt b, cancellation_token token) {
+    double cost = mul_vector_cost(a.size(), b.size());
+    return submit<BigInt>(cost, token, [a = std::move(a), b = std::move(b)] { return mul_vector(a, b); });
+}
+
+// Parsing and printing run on the pool as part of the request.
+std::future<std::string> async_multiply(std::string a, std::string b, cancellation_token token) {
+    double cost = mul_vector_cost(a.size(), b.size());
+    return submit<std::string>(cost, token, [a = std::move(a), b = std::move(b)] {
+        return mul_decimal(a, b);
+    });
+}
@@ -0,0 +1,61 @@
+#include "bigint_multiply.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+
+#include "parlaylib/include/parlay/parallel.h"
+
+#include "bigint_profile.h"
+
+using BigInt = std::vector<long long>;
+
+// Runs job(i) for every i on the parlay pool, largest first. Each worker
+// takes the most expensive job not yet started from a shared counter, which
+// is greedy longest-processing-time scheduling. Products below mul_vector's
+// parallel threshold run whole on one worker. Larger ones spawn their own
+// par_do branches. Workers that run out of jobs steal those branches, so the
+// big products at the front of the order are finished by the whole pool.
+template <typename F>
+static void run_largest_first(const std::vector<double>& cost, F&& job) {
+    std::vector<size_t> order(cost.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return cost[a] > cost[b]; });
+
+    std::atomic<size_t> next{0};
+    size_t workers = std::min<size_t>(parlay::num_workers(), order.size());
+    bigint_parallel_for(0, workers, [&](size_t) {
+        for (size_t i = next++; i < order.size(); i = next++) {
+            job(order[i]);
+        }
+    }, 1);
+}
+
+std::vector<BigInt> multiply_batch(const std::vector<std::pair<BigInt, BigInt>>& jobs) {
+    std::vector<double> cost(jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        cost[i] = mul_vector_cost(jobs[i].first.size(), jobs[i].second.size());
+    }
+
+    std::vector<BigInt> results(jobs.size());
+    run_largest_first(cost, [&](size_t i) {
+        results[i] = mul_vector(jobs[i].first, jobs[i].second);
+    });
+    return results;
+}
+
+// Parsing and printing happen inside each job, so they are spread over the
+// pool along with the products.
+std::vector<std::string> multiply_batch(const std::vector<std::pair<std::string, std::string>>& jobs) {
+    std::vector<double> cost(jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        cost[i] = mul_vector_cost(jobs[i].first.size(), jobs[i].second.size());
+    }
+
+    std::vector<std::string> results(jobs.size());
+    run_largest_first(cost, [&](size_t i) {
+        results[i] = mul_decimal(jobs[i].first, jobs[i].second);
+    });
+    return results;
+}
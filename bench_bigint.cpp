@@ -0,0 +1,319 @@
+// Benchmarks for the multiplication kernels, modeled on
+// parlaylib/benchmark/bench_standard.cpp. Operands are generated and padded
+// outside the timed region, so only the kernel itself is measured.
+//
+// Run a subset with e.g.
+//   ./bench_bigint --benchmark_filter='toom_cook.*/1000000'
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bigint_multiply.h"
+
+#include "parlaylib/include/parlay/parallel.h"
+#include "parlaylib/include/parlay/random.h"
+
+using benchmark::Counter;
+
+using digits = std::vector<long long>;
+using kernel = digits (*)(const digits&, const digits&);
+
+// Use this macro to avoid accidentally timing the destructors
+// of the output produced by algorithms that return data
+#define RUN_AND_CLEAR(e)      \
+  {                           \
+    auto result_ = (e);       \
+    state.PauseTiming();      \
+  }                           \
+  state.ResumeTiming();
+
+// Report throughput for a product of an n-digit and an m-digit operand.
+// Digits/sec counts input digits; limb-ops/sec counts the leading-term
+// number of digit multiplications the algorithm performs, so kernels with
+// different asymptotics can be compared on one scale.
+#define REPORT_STATS(n, m, ops)                                                                      \
+  state.counters["    Digits/sec"] = Counter(state.iterations()*double((n) + (m)), Counter::kIsRate); \
+  state.counters[" Limb-ops/sec"] = Counter(state.iterations()*double(ops), Counter::kIsRate);
+
+// Run e once more outside the timed loop with the allocation counters
+// reset, and report its heap usage.
+#define REPORT_MEMORY(e)                                                                            \
+  {                                                                                                 \
+    allocation_stats_reset();                                                                       \
+    { auto result_ = (e); }                                                                         \
+    allocation_stats m_ = allocation_stats_read();                                                  \
+    state.counters["Peak bytes"] = Counter(double(m_.peak_bytes), Counter::kDefaults, Counter::kIs1024); \
+    state.counters["Alloc bytes"] = Counter(double(m_.total_bytes), Counter::kDefaults, Counter::kIs1024); \
+    state.counters["Allocs"] = double(m_.allocations);                                              \
+  }
+
+static constexpr size_t KARATSUBA_THRESHOLD = 64;
+static constexpr size_t SEED = 1234;
+
+static size_t next_power_of_2(size_t n) {
+  size_t p = 1;
+  while (p < n) p <<= 1;
+  return p;
+}
+
+static digits operand(size_t n, size_t seed, size_t padded_length = 0) {
+  digits v = random_bigint_vector(n, seed);
+  v.resize(std::max(n, padded_length), 0);
+  return v;
+}
+
+// Digit multiplications for an n-digit product: the recursion runs on
+// n / threshold-sized leaves and each leaf is a schoolbook product.
+static double naive_ops(double n) { return n * n; }
+static double recursive_ops(double n, double branching, double split) {
+  if (n <= KARATSUBA_THRESHOLD) return naive_ops(n);
+  double levels = std::log(n / KARATSUBA_THRESHOLD) / std::log(split);
+  return std::pow(branching, levels) * naive_ops(KARATSUBA_THRESHOLD);
+}
+static double karatsuba_ops(double n) { return recursive_ops(n, 3, 2); }
+static double toom_cook_ops(double n) { return recursive_ops(n, 5, 3); }
+
+// Balanced n-by-n product. Karatsuba kernels need power-of-two lengths, so
+// their operands are padded up front.
+static void bench_balanced(benchmark::State& state, kernel K, bool power_of_2, double (*ops)(double)) {
+  size_t n = state.range(0);
+  size_t len = power_of_2 ? next_power_of_2(n) : n;
+  digits x = operand(n, SEED, len);
+  digits y = operand(n, SEED + 1, len);
+
+  for (auto _ : state) {
+    RUN_AND_CLEAR(K(x, y));
+  }
+
+  REPORT_STATS(n, n, ops(double(len)));
+  REPORT_MEMORY(K(x, y));
+}
+
+// x * x with both arguments aliasing one vector.
+static void bench_square(benchmark::State& state, kernel K, bool power_of_2, double (*ops)(double)) {
+  size_t n = state.range(0);
+  size_t len = power_of_2 ? next_power_of_2(n) : n;
+  digits x = operand(n, SEED, len);
+
+  for (auto _ : state) {
+    RUN_AND_CLEAR(K(x, x));
+  }
+
+  REPORT_STATS(n, n, ops(double(len)));
+  REPORT_MEMORY(K(x, x));
+}
+
+// Repeated balanced products through one mul_context. The arena is sized by
+// the warm-up call, so the timed calls only allocate their results.
+static void bench_context(benchmark::State& state) {
+  size_t n = state.range(0);
+  digits x = operand(n, SEED);
+  digits y = operand(n, SEED + 1);
+  normalize_vector(x);
+  normalize_vector(y);
+  mul_context context;
+  digits out;
+  context.multiply(x, y, out);
+
+  for (auto _ : state) {
+    context.multiply(x, y, out);
+  }
+
+  REPORT_STATS(n, n, karatsuba_ops(double(next_power_of_2(n))));
+  REPORT_MEMORY(context.multiply(x, y));
+}
+
+// bench_context under each numa_placement. The arenas are placed by the
+// warm-up call and keep their pages, so the timed calls measure the steady
+// state of a long-lived context. On a single node the three coincide.
+static void bench_numa(benchmark::State& state, numa_placement placement) {
+  size_t n = state.range(0);
+  digits x = operand(n, SEED);
+  digits y = operand(n, SEED + 1);
+  normalize_vector(x);
+  normalize_vector(y);
+  mul_context context(placement);
+  digits out;
+  context.multiply(x, y, out);
+
+  for (auto _ : state) {
+    context.multiply(x, y, out);
+  }
+
+  REPORT_STATS(n, n, karatsuba_ops(double(next_power_of_2(n))));
+  state.counters["Nodes"] = double(numa_nodes());
+}
+
+// n-by-(n / ratio) product through mul_vector, which slices the longer
+// operand instead of padding the shorter one.
+static void bench_unbalanced(benchmark::State& state) {
+  size_t n = state.range(0);
+  size_t m = std::max<size_t>(1, n / state.range(1));
+  digits x = operand(n, SEED);
+  digits y = operand(m, SEED + 1);
+
+  for (auto _ : state) {
+    RUN_AND_CLEAR(mul_vector(x, y));
+  }
+
+  REPORT_STATS(n, m, double(n / m) * toom_cook_ops(double(m)));
+  REPORT_MEMORY(mul_vector(x, y));
+}
+
+// A mixed batch of independent products, with operand lengths log-uniform
+// between 100 and 20000 digits, so a few large products dominate the work.
+using batch = std::vector<std::pair<digits, digits>>;
+
+static batch mixed_batch(size_t count) {
+  parlay::random_generator gen(SEED);
+  std::uniform_real_distribution<double> exponent(2, std::log10(20000.0));
+  batch jobs(count);
+  for (size_t i = 0; i < count; ++i) {
+    auto r = gen[i];
+    size_t n = size_t(std::pow(10, exponent(r)));
+    size_t m = size_t(std::pow(10, exponent(r)));
+    jobs[i] = {operand(n, SEED + 2 * i), operand(m, SEED + 2 * i + 1)};
+  }
+  return jobs;
+}
+
+static void report_batch(benchmark::State& state, const batch& jobs) {
+  double total = 0;
+  for (const auto& job : jobs) total += double(job.first.size() + job.second.size());
+  state.counters["    Digits/sec"] = Counter(state.iterations() * total, Counter::kIsRate);
+  state.counters["Products/sec"] = Counter(state.iterations() * double(jobs.size()), Counter::kIsRate);
+}
+
+// multiply_batch: one pool, largest first.
+static void bench_batch(benchmark::State& state) {
+  batch jobs = mixed_batch(state.range(0));
+  for (auto _ : state) {
+    RUN_AND_CLEAR(multiply_batch(jobs));
+  }
+  report_batch(state, jobs);
+}
+
+// Baselines: one product at a time, each parallel inside, and all products
+// in a parallel_for in input order.
+static void bench_batch_serial(benchmark::State& state) {
+  batch jobs = mixed_batch(state.range(0));
+  for (auto _ : state) {
+    std::vector<digits> results(jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i) {
+      results[i] = mul_vector(jobs[i].first, jobs[i].second);
+    }
+    state.PauseTiming();
+    results = {};
+    state.ResumeTiming();
+  }
+  report_batch(state, jobs);
+}
+
+static void bench_batch_input_order(benchmark::State& state) {
+  batch jobs = mixed_batch(state.range(0));
+  for (auto _ : state) {
+    std::vector<digits> results(jobs.size());
+    parlay::parallel_for(0, jobs.size(), [&](size_t i) {
+      results[i] = mul_vector(jobs[i].first, jobs[i].second);
+    }, 1);
+    state.PauseTiming();
+    results = {};
+    state.ResumeTiming();
+  }
+  report_batch(state, jobs);
+}
+
+// End-to-end latency of one small product through the string interface:
+// parse both operands, multiply, print. Every iteration is timed on its own
+// so the tail is reported as well as the median.
+using string_kernel = std::string (*)(const std::string&, const std::string&);
+
+static void bench_small_latency(benchmark::State& state, string_kernel K) {
+  size_t n = state.range(0);
+  std::string a = random_bigint(n, SEED);
+  std::string b = random_bigint(n, SEED + 1);
+  std::vector<double> samples;
+  for (auto _ : state) {
+    auto start = std::chrono::steady_clock::now();
+    benchmark::DoNotOptimize(K(a, b));
+    samples.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+  }
+  std::sort(samples.begin(), samples.end());
+  state.counters["p50 us"] = samples[samples.size() / 2];
+  state.counters["p99 us"] = samples[std::min(samples.size() - 1, size_t(0.99 * samples.size()))];
+}
+
+// ------------------------- Registration -------------------------------
+
+#define BENCH(NAME, KERNEL, SHAPE, POW2, OPS, MAX)                              \
+  BENCHMARK_CAPTURE(bench_ ## SHAPE, NAME, KERNEL, POW2, OPS)                   \
+                          ->UseRealTime()                                       \
+                          ->Unit(benchmark::kMillisecond)                       \
+                          ->RangeMultiplier(10)                                 \
+                          ->Range(100, MAX);
+
+// The schoolbook kernel stops at 10^5 digits; at 10^8 a single run would
+// take days.
+#define NAIVE_MAX_DIGITS 100000
+#define MAX_DIGITS 100000000
+
+BENCH(naive, naive_mul_vector, balanced, false, naive_ops, NAIVE_MAX_DIGITS);
+BENCH(karatsuba, karatsuba_mul_vector, balanced, true, karatsuba_ops, MAX_DIGITS);
+BENCH(par_karatsuba, par_karatsuba_mul_vector, balanced, true, karatsuba_ops, MAX_DIGITS);
+BENCH(par_karatsuba_plib, par_karatsuba_mul_vector_plib, balanced, true, karatsuba_ops, MAX_DIGITS);
+BENCH(toom_cook, toom_cook_mul_vector, balanced, false, toom_cook_ops, MAX_DIGITS);
+BENCH(par_toom_cook, par_toom_cook_mul_vector, balanced, false, toom_cook_ops, MAX_DIGITS);
+BENCH(par_toom_cook_plib, par_toom_cook_mul_vector_plib, balanced, false, toom_cook_ops, MAX_DIGITS);
+
+BENCH(naive, naive_mul_vector, square, false, naive_ops, NAIVE_MAX_DIGITS);
+BENCH(karatsuba, karatsuba_mul_vector, square, true, karatsuba_ops, MAX_DIGITS);
+BENCH(par_karatsuba, par_karatsuba_mul_vector, square, true, karatsuba_ops, MAX_DIGITS);
+BENCH(par_karatsuba_plib, par_karatsuba_mul_vector_plib, square, true, karatsuba_ops, MAX_DIGITS);
+BENCH(toom_cook, toom_cook_mul_vector, square, false, toom_cook_ops, MAX_DIGITS);
+BENCH(par_toom_cook, par_toom_cook_mul_vector, square, false, toom_cook_ops, MAX_DIGITS);
+BENCH(par_toom_cook_plib, par_toom_cook_mul_vector_plib, square, false, toom_cook_ops, MAX_DIGITS);
+
+BENCHMARK(bench_context)->UseRealTime()
+                        ->Unit(benchmark::kMillisecond)
+                        ->RangeMultiplier(10)
+                        ->Range(100, MAX_DIGITS);
+
+#define NUMA_PLACEMENT(NAME)                                                    \
+  BENCHMARK_CAPTURE(bench_numa, NAME, numa_placement::NAME)                     \
+                          ->UseRealTime()                                       \
+                          ->Unit(benchmark::kMillisecond)                       \
+                          ->RangeMultiplier(4)                                  \
+                          ->Range(1 << 15, 1 << 23);
+
+NUMA_PLACEMENT(naive);
+NUMA_PLACEMENT(interleave);
+NUMA_PLACEMENT(local);
+
+BENCHMARK(bench_unbalanced)->UseRealTime()
+                           ->Unit(benchmark::kMillisecond)
+                           ->ArgsProduct({benchmark::CreateRange(1000, MAX_DIGITS, 10), {4, 16, 256}});
+
+BENCHMARK(bench_batch)->UseRealTime()->Unit(benchmark::kMillisecond)->Arg(100)->Arg(1000);
+BENCHMARK(bench_batch_serial)->UseRealTime()->Unit(benchmark::kMillisecond)->Arg(100)->Arg(1000);
+BENCHMARK(bench_batch_input_order)->UseRealTime()->Unit(benchmark::kMillisecond)->Arg(100)->Arg(1000);
+
+#define SMALL_LATENCY(NAME, KERNEL)                                             \
+  BENCHMARK_CAPTURE(bench_small_latency, NAME, KERNEL)                          \
+                          ->UseRealTime()                                       \
+                          ->Unit(benchmark::kMicrosecond)                       \
+                          ->RangeMultiplier(10)                                 \
+                          ->Range(10, 10000);
+
+SMALL_LATENCY(karatsuba, karatsuba_mul_string);
+SMALL_LATENCY(par_karatsuba, par_karatsuba_mul_string);
+SMALL_LATENCY(toom_cook, toom_cook_mul_string);
+SMALL_LATENCY(par_toom_cook, par_toom_cook_mul_string);
+SMALL_LATENCY(par_toom_cook_plib, par_toom_cook_mul_string_plib);
+
+BENCHMARK_MAIN();
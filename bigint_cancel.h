@@ -0,0 +1,34 @@
+#ifndef BIGINT_CANCEL_H
+#define BIGINT_CANCEL_H
+
+// Cooperative cancellation inside the kernels. The token of the request a
+// thread is working on is kept in a thread-local pointer. The spawn wrappers
+// in bigint_trace.h hand it to every branch, so stolen branches see it too.
+// Kernels poll it at task boundaries. A cancelled kernel returns a zero
+// product of the usual shape: parlay does not carry exceptions across
+// stolen tasks, so unwinding is left to the caller that installed the token.
+
+#include "bigint_multiply.h"
+
+const cancellation_token* &cancellation_current();
+
+inline bool cancellation_requested() {
+    const cancellation_token* token = cancellation_current();
+    return token != nullptr && token->cancelled();
+}
+
+// Installs token on this thread for the lifetime of the scope.
+class cancellation_scope {
+public:
+    explicit cancellation_scope(const cancellation_token* token) : saved(cancellation_current()) {
+        cancellation_current() = token;
+    }
+    ~cancellation_scope() { cancellation_current() = saved; }
+    cancellation_scope(const cancellation_scope&) = delete;
+    cancellation_scope& operator=(const cancellation_scope&) = delete;
+
+private:
+    const cancellation_token* saved;
+};
+
+#endif // BIGINT_CANCEL_H
@@ -10,6 +10,12 @@
 #include <random>
 #include <cmath>
 #include <limits>
+#include <cstdint>
+#include <array>
+#include <memory>
+#include <chrono>
+#include <future>
+#include <stdexcept>
 
 std::string naive_mul_string(const std::string &a, const std::string &b);
 std::string karatsuba_mul_string(const std::string &a, const std::string &b);
@@ -24,10 +30,437 @@ std::vector<long long> par_karatsuba_mul_vector(const std::vector<long long>& x,
 std::vector<long long> toom_cook_mul_vector(const std::vector<long long>& x, const std::vector<long long>& y);
 std::vector<long long> par_toom_cook_mul_vector(const std::vector<long long>& x, const std::vector<long long>& y);
 
+// Short and middle products on coefficient vectors; see naive.cpp and seq_karatsuba.cpp
+std::vector<long long> naive_mullo_vector(const std::vector<long long>& x, const std::vector<long long>& y);
+std::vector<long long> naive_mulhi_vector(const std::vector<long long>& x, const std::vector<long long>& y);
+std::vector<long long> naive_middle_product_vector(const std::vector<long long>& x, const std::vector<long long>& y);
+std::vector<long long> karatsuba_mullo_vector(const std::vector<long long>& x, const std::vector<long long>& y);
+std::vector<long long> karatsuba_mulhi_vector(const std::vector<long long>& x, const std::vector<long long>& y);
+std::vector<long long> karatsuba_middle_product_vector(const std::vector<long long>& x, const std::vector<long long>& y);
+
+std::vector<long long> par_karatsuba_mul_vector_plib(const std::vector<long long>& x, const std::vector<long long>& y);
+std::vector<long long> par_toom_cook_mul_vector_plib(const std::vector<long long>& x, const std::vector<long long>& y);
+
+// Toom-3 evaluation tree of a fixed operand: points holds the evaluations at
+// 0, 1, -1, -2, inf of each level, and value the digits where evaluation stops.
+struct toom_cook_evaluation {
+    size_t length = 0;
+    std::vector<long long> value;
+    std::vector<toom_cook_evaluation> points;
+};
+toom_cook_evaluation par_toom_cook_evaluate_plib(const std::vector<long long>& x, size_t max_depth);
+std::vector<long long> par_toom_cook_mul_vector_prepared_plib(const toom_cook_evaluation& x, const std::vector<long long>& y);
+
+// Operations on normalized digit vectors (little-endian base-10 digits, no leading zeros)
+void normalize_vector(std::vector<long long>& v);
+std::vector<long long> mul_vector(const std::vector<long long>& x, const std::vector<long long>& y);
+// Relative work of an n-by-m mul_vector, for ordering products largest first.
+double mul_vector_cost(size_t n, size_t m);
+// Decimal strings through mul_vector, parsed and printed on the calling
+// thread, for use inside jobs already running on the parlay pool.
+std::string mul_decimal(const std::string& a, const std::string& b);
+int compare_vector(const std::vector<long long>& x, const std::vector<long long>& y);
+std::vector<long long> add_vector(const std::vector<long long>& x, const std::vector<long long>& y);
+std::vector<long long> sub_vector(const std::vector<long long>& x, const std::vector<long long>& y);
+std::vector<long long> shift_vector(const std::vector<long long>& x, size_t n);
+std::vector<long long> shift_down_vector(const std::vector<long long>& x, size_t n);
+
+std::vector<long long> product_mul_vector(const std::vector<std::vector<long long>>& factors);
+std::string product_mul_string(const std::vector<std::string>& factors);
+
+// Independent products scheduled together on the parlay pool, largest first.
+// Small products run whole on one worker; large ones also split internally.
+// Results are in the order of the jobs.
+std::vector<std::vector<long long>> multiply_batch(
+    const std::vector<std::pair<std::vector<long long>, std::vector<long long>>>& jobs);
+std::vector<std::string> multiply_batch(const std::vector<std::pair<std::string, std::string>>& jobs);
+
+// Cancels asynchronous work: either explicitly with cancel() or when its
+// deadline passes. Copies share state, so the caller keeps one copy and
+// passes another with the request.
+class cancellation_token {
+public:
+    cancellation_token();
+    explicit cancellation_token(std::chrono::steady_clock::time_point deadline);
+
+    static cancellation_token with_timeout(std::chrono::steady_clock::duration timeout);
+
+    void cancel() const;
+    bool cancelled() const;
+
+private:
+    struct state;
+    std::shared_ptr<state> shared;
+};
+
+class multiply_cancelled : public std::runtime_error {
+public:
+    multiply_cancelled() : std::runtime_error("multiplication cancelled") {}
+};
+
+// Queues a product on a shared background pool and returns at once. The
+// kernels poll the token at task boundaries. Work for a cancelled or
+// expired request stops at the next boundary, and its future then throws
+// multiply_cancelled.
+std::future<std::vector<long long>> async_multiply(std::vector<long long> a, std::vector<long long> b,
+                                                   cancellation_token token = cancellation_token());
+std::future<std::string> async_multiply(std::string a, std::string b,
+                                        cancellation_token token = cancellation_token());
+
+// Connection to a multiply_server on a Unix domain socket. Calls block until
+// the server replies; server-side errors are thrown as std::runtime_error.
+// A client is not thread-safe: use one connection per thread.
+class multiply_client {
+public:
+    explicit multiply_client(const std::string& socket_path);
+    ~multiply_client();
+    multiply_client(multiply_client&& other) noexcept;
+    multiply_client& operator=(multiply_client&& other) noexcept;
+
+    // Normalized digits of x * y.
+    std::vector<long long> multiply(const std::vector<long long>& x, const std::vector<long long>& y);
+    std::string multiply(const std::string& a, const std::string& b);
+    // The server's counters and latency percentiles, as JSON.
+    std::string stats();
+
+private:
+    std::string request(uint32_t type, const std::vector<long long>* x, const std::vector<long long>* y,
+                        std::vector<long long>* product);
+
+    int fd = -1;
+    uint64_t next_id = 1;
+};
+
+std::pair<std::vector<long long>, std::vector<long long>> divmod_vector(const std::vector<long long>& a, const std::vector<long long>& b);
+std::vector<long long> reciprocal_vector(const std::vector<long long>& b, size_t precision);
+std::pair<std::string, std::string> divmod_string(const std::string &a, const std::string &b);
+std::string div_string(const std::string &a, const std::string &b);
+std::string mod_string(const std::string &a, const std::string &b);
+
+// Modular exponentiation with per-modulus precomputation. Moduli coprime to 10
+// use Montgomery multiplication with R = 10^n, all others Barrett reduction.
+class modexp_engine {
+public:
+    explicit modexp_engine(const std::vector<long long>& modulus);
+
+    std::vector<long long> pow(const std::vector<long long>& base, const std::vector<long long>& exponent) const;
+    std::vector<std::vector<long long>> pow_batch(const std::vector<std::pair<std::vector<long long>, std::vector<long long>>>& jobs) const;
+
+    bool uses_montgomery() const { return montgomery; }
+
+private:
+    std::vector<long long> barrett_reduce(const std::vector<long long>& x) const;
+    std::vector<long long> redc(const std::vector<long long>& x) const;
+    std::vector<long long> mul_mod(const std::vector<long long>& a, const std::vector<long long>& b) const;
+
+    std::vector<long long> m;
+    size_t n = 0;
+    bool montgomery = false;
+    std::vector<long long> mu;       // Barrett: floor(10^2n / m)
+    std::vector<long long> m_prime;  // Montgomery: -m^-1 mod 10^n
+    std::vector<long long> r2;       // Montgomery: 10^2n mod m
+};
+
+// An operand that is multiplied many times: converted to digits once and
+// kept as its Toom-3 evaluation tree, so each product only evaluates the
+// other side.
+class prepared_multiplicand {
+public:
+    explicit prepared_multiplicand(const std::vector<long long>& operand);
+    explicit prepared_multiplicand(const std::string& operand);
+
+    std::vector<long long> multiply(const std::vector<long long>& y) const;
+    std::string multiply(const std::string& y) const;
+
+    size_t size() const { return digits.size(); }
+
+private:
+    std::vector<long long> digits;
+    toom_cook_evaluation evaluation;
+};
+
+// Where mul_context puts its memory on a machine with several NUMA nodes
+// (numa.cpp).
+// - naive: each page lands on the node of the first thread to touch it. For
+//   a plain allocation that is the caller's node, so workers on every other
+//   node read remote memory.
+// - interleave: pages are spread round-robin over the nodes.
+// - local: the top-level subproducts of a large product are split among the
+//   nodes. Each node's share is computed by threads bound to that node, with
+//   operands and scratch that those threads touch first.
+// On a single node all three place pages the same way.
+enum class numa_placement { naive, interleave, local };
+
+// NUMA nodes with CPUs this process may run on. Returns 1 when the system
+// reports no NUMA information.
+size_t numa_nodes();
+
+// Limbs in anonymous pages. Unlike a std::vector, allocating does not touch
+// them, so each page lands where the placement says (numa.cpp). node picks
+// the node for local placement; an out-of-range node leaves placement to
+// first touch. Local placement is then touched in parallel by the workers of
+// the calling thread's scheduler.
+class numa_array {
+public:
+    numa_array() = default;
+    numa_array(size_t n, numa_placement placement, size_t node = size_t(-1));
+    ~numa_array();
+    numa_array(numa_array&& other) noexcept;
+    numa_array& operator=(numa_array&& other) noexcept;
+    numa_array(const numa_array&) = delete;
+    numa_array& operator=(const numa_array&) = delete;
+
+    long long* data() { return limbs; }
+    size_t size() const { return count; }
+
+private:
+    long long* limbs = nullptr;
+    size_t count = 0;
+};
+
+class node_pool;
+
+// State reused across products of similar sizes, so repeated calls do no
+// setup. The scratch arena grows to the largest product seen and is then
+// reused. The scratch layout and parallel depth are cached for each
+// power-of-two length. The worker pool is the parlay scheduler of the
+// constructing thread, started in the constructor rather than on the first
+// product. Products use a Karatsuba that works in place in the arena, so
+// once it is large enough a call allocates nothing but its result.
+// multiply(x, y, out) reuses out's capacity as well. A context serves one
+// call at a time. Memory is placed as in numa_placement. With local
+// placement, each node also keeps an arena and a bound scheduler of its own
+// between products, both created by the first product split among the nodes.
+class mul_context {
+public:
+    explicit mul_context(numa_placement placement = numa_placement::local);
+    ~mul_context();
+
+    std::vector<long long> multiply(const std::vector<long long>& x, const std::vector<long long>& y);
+    void multiply(const std::vector<long long>& x, const std::vector<long long>& y, std::vector<long long>& out);
+    std::string multiply(const std::string& a, const std::string& b);
+
+    size_t workers() const { return num_workers; }
+    size_t arena_size() const { return arena.size(); }
+    numa_placement placement() const { return place; }
+    // Arena limbs a product whose shorter operand has this length needs.
+    size_t arena_needed(size_t length);
+
+private:
+    struct plan {
+        size_t parallel_depth = 0;
+        size_t scratch = 0;
+    };
+    const plan& plan_for(size_t length);
+    void multiply_on_nodes(const long long* x, const long long* y, size_t n, long long* out, long long* scratch);
+
+    numa_placement place;
+    size_t num_workers = 1;
+    size_t nodes = 1;
+    numa_array arena;
+    std::vector<numa_array> node_arenas;
+    std::unique_ptr<node_pool> node_workers;
+    std::vector<plan> plans;  // indexed by log2 of the length; scratch 0 = not yet computed
+};
+
+// A product kept as its raw coefficient vector. The leading and trailing
+// digits are available without carrying through the whole result; the full
+// decimal string is only built by str().
+class decimal_view {
+public:
+    explicit decimal_view(std::vector<long long> coefficients);
+
+    size_t size() const;
+    std::string head(size_t k) const;
+    std::string tail(size_t k) const;
+    std::string truncated(size_t head_len = 50, size_t tail_len = 50) const;
+    std::string str() const;
+    std::vector<long long> digits() const;
+    uint64_t residue(uint64_t p) const;
+
+    bool operator==(const decimal_view& other) const { return digits() == other.digits(); }
+    bool operator!=(const decimal_view& other) const { return !(*this == other); }
+
+private:
+    struct top_digits {
+        size_t offset;
+        std::vector<long long> digits;
+    };
+    top_digits top(size_t k) const;
+
+    std::vector<long long> coeffs;
+};
+
+// Randomized verification: residues modulo 61-bit primes, computed by a
+// parallel reduction over the digits.
+uint64_t residue_vector(const std::vector<long long>& v, uint64_t p);
+uint64_t residue_string(const std::string& s, uint64_t p);
+std::vector<uint64_t> random_primes_61(size_t count, size_t seed);
+bool modular_check(const std::string& a, const std::string& b, const decimal_view& c,
+                   size_t rounds = 4, size_t seed = 0);
+bool modular_check(const std::vector<long long>& a, const std::vector<long long>& b,
+                   const std::vector<long long>& c, size_t rounds = 4, size_t seed = 0);
+
+namespace parlay { class file_map; }
+
+// A decimal number in a text file, mapped with parlay::file_map rather than
+// read. Surrounding whitespace is ignored; anything else that is not a digit
+// is rejected by the constructor with the offset of the first bad byte.
+class decimal_file {
+public:
+    explicit decimal_file(const std::string& path);
+    ~decimal_file();
+    decimal_file(decimal_file&&) noexcept;
+    decimal_file& operator=(decimal_file&&) noexcept;
+
+    size_t size() const;
+    // Little-endian digits, parsed in parallel from the mapping and padded
+    // with zeros up to length.
+    std::vector<long long> digits(size_t length = 0) const;
+
+private:
+    std::unique_ptr<parlay::file_map> map;
+    const char* first = nullptr;
+    const char* last = nullptr;
+};
+
+// Writes normalized little-endian digits as decimal text plus a newline.
+// Chunks are formatted in parallel and written with pwrite.
+void write_decimal_file(const std::string& path, const std::vector<long long>& digits);
+
+// Versioned binary limb files: a 64-byte header (magic "BIGLIMBS", version,
+// limb size, base, limb count, checksum, sign) followed by the raw
+// little-endian limbs. The limbs are coefficients in the given base, least
+// significant first. They may be uncarried, as normalize_vector accepts.
+// Opening a file maps it and reads only the header. data() points into the
+// mapping, so loading costs O(1) regardless of the operand size.
+// first_index is the position of limbs[0] in the whole number, so a long
+// number can be checksummed in pieces whose results are summed.
+uint64_t limb_checksum(const long long* limbs, size_t n, size_t first_index = 0);
+
+class limb_file {
+public:
+    explicit limb_file(const std::string& path);
+    ~limb_file();
+    limb_file(limb_file&&) noexcept;
+    limb_file& operator=(limb_file&&) noexcept;
+
+    // Whether path starts with the limb file magic.
+    static bool matches(const std::string& path);
+
+    const long long* data() const { return limbs; }
+    size_t size() const { return count; }
+    uint64_t base() const { return limb_base; }
+    bool negative() const { return sign; }
+
+    // Recomputes the checksum over the mapped limbs (O(n), in parallel).
+    bool verify() const;
+    // Copy of the limbs, padded with zeros up to length.
+    std::vector<long long> to_vector(size_t length = 0) const;
+
+private:
+    std::unique_ptr<parlay::file_map> map;
+    const long long* limbs = nullptr;
+    size_t count = 0;
+    uint64_t limb_base = 10;
+    bool sign = false;
+    uint64_t expected_checksum = 0;
+};
+
+void write_limb_file(const std::string& path, const long long* limbs, size_t n,
+                     bool negative = false, uint64_t base = 10);
+void write_limb_file(const std::string& path, const std::vector<long long>& limbs,
+                     bool negative = false, uint64_t base = 10);
+
+// Out-of-core product of two base-10 limb files whose digits are 0-9,
+// written as a limb file. Working memory (tile buffers plus the kernel's
+// scratch) stays within memory_budget bytes. The inputs are read through
+// their mappings one tile at a time and the product is written front to
+// back. See out_of_core.cpp.
+struct out_of_core_stats {
+    size_t tile_digits = 0;
+    size_t working_bytes = 0;
+    size_t tile_products = 0;
+    size_t bytes_read = 0;
+    size_t bytes_written = 0;
+    size_t product_digits = 0;
+};
+out_of_core_stats multiply_limb_files(const std::string& a_path, const std::string& b_path,
+                                      const std::string& output_path, size_t memory_budget);
+
+// Summary statistics over repeated timings, in the samples' unit.
+struct timing_summary {
+    size_t count = 0;
+    double mean = 0;
+    double stddev = 0;
+    double rse = 0;  // standard error of the mean / mean
+    double min = 0;
+    double p10 = 0;
+    double median = 0;
+    double p90 = 0;
+};
+timing_summary summarize_times(std::vector<double> samples);
+
+// Heap usage between allocation_stats_reset() and allocation_stats_read(),
+// counted by the global operator new/delete in memory_stats.cpp. That file
+// is not part of the library: only multiply_test and bench_bigint link it,
+// and only programs that link it may call these.
+// parlay_pool_bytes is the change in the bytes handed out by parlay's pool
+// allocator, which recycles blocks without going back to operator new.
+struct allocation_stats {
+    size_t peak_bytes = 0;
+    size_t total_bytes = 0;
+    size_t allocations = 0;
+    long long parlay_pool_bytes = 0;
+};
+void allocation_stats_reset();
+allocation_stats allocation_stats_read();
+
+// Hardware event counts over one measured region, summed over all threads of
+// the process. Events the kernel or the hardware does not provide are -1.
+struct perf_sample {
+    long long cycles = -1;
+    long long instructions = -1;
+    long long llc_misses = -1;
+    long long dtlb_misses = -1;
+    long long branch_misses = -1;
+    long long task_clock_ns = -1;  // CPU time, a software event
+
+    double ipc() const;
+};
+
+// perf_event_open counters opened on every thread in /proc/self/task at
+// start() and read back and closed at stop().
+class perf_counters {
+public:
+    static constexpr size_t NUM_EVENTS = 6;
+
+    perf_counters() = default;
+    ~perf_counters();
+    perf_counters(const perf_counters&) = delete;
+    perf_counters& operator=(const perf_counters&) = delete;
+
+    void start();
+    perf_sample stop();
+
+    // Why the first event that could not be opened failed, or empty.
+    const std::string& error() const { return error_message; }
+
+private:
+    void close_all();
+
+    std::array<std::vector<int>, NUM_EVENTS> fds;
+    std::string error_message;
+};
+
+std::string modexp_string(const std::string &base, const std::string &exponent, const std::string &modulus);
+
 std::vector<long long> string_to_vector(const std::string& s, bool pad_to_power_of_2 = false);
 std::string vector_to_string(const std::vector<long long>& v);
 
 std::string random_bigint(size_t len);
+std::string random_bigint(size_t len, size_t seed);
+std::vector<long long> random_bigint_vector(size_t len, size_t seed);
 std::string truncate_display(const std::string &s, size_t head = 50, size_t tail = 50);
 
 #endif // BIGINT_MULTIPLY_H
\ No newline at end of file
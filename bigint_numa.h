@@ -0,0 +1,45 @@
+#ifndef BIGINT_NUMA_H
+#define BIGINT_NUMA_H
+
+// Node binding behind numa_placement::local (numa.cpp).
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// One thread per node numa_nodes() counts, bound to that node's CPUs and
+// running a parlay scheduler of its own for as long as the pool lives. The
+// scheduler's workers inherit the binding. Each node gets its share of
+// workers in proportion to its CPUs. Between calls the threads wait on a
+// condition variable and their workers sleep, so a pool kept next to the
+// caller's scheduler costs nothing while unused.
+class node_pool {
+public:
+    explicit node_pool(size_t workers);
+    ~node_pool();
+    node_pool(const node_pool&) = delete;
+    node_pool& operator=(const node_pool&) = delete;
+
+    // Runs f(node) for every node on that node's scheduler. Returns once all
+    // are done, rethrowing the first exception thrown.
+    void run(const std::function<void(size_t)>& f);
+
+private:
+    void serve(size_t node);
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    const std::function<void(size_t)>* task = nullptr;
+    size_t generation = 0;
+    size_t remaining = 0;
+    bool stopping = false;
+    std::vector<std::exception_ptr> errors;
+    std::vector<std::thread> threads;
+};
+
+#endif // BIGINT_NUMA_H
@@ -0,0 +1,215 @@
+#include "bigint_multiply.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cmath>
+
+#include "parlaylib/include/parlay/parallel.h"
+
+#include "bigint_profile.h"
+
+static constexpr size_t BASECASE_THRESHOLD = 64;
+static constexpr size_t PARALLEL_THRESHOLD = 10000;
+
+// Propagates carries so every entry is a single decimal digit, then strips
+// leading zeros (keeping at least one digit). Entries may be negative on input
+// as long as the represented value is not.
+void normalize_vector(std::vector<long long>& v) {
+    BIGINT_PROFILE_BEGIN(carry);
+    long long carry = 0;
+    for (size_t i = 0; i < v.size(); ++i) {
+        long long cur = v[i] + carry;
+        carry = cur / 10;
+        cur %= 10;
+        if (cur < 0) {
+            cur += 10;
+            carry -= 1;
+        }
+        v[i] = cur;
+    }
+    while (carry > 0) {
+        v.push_back(carry % 10);
+        carry /= 10;
+    }
+
+    size_t idx = v.size();
+    while (idx > 1 && v[idx - 1] == 0) {
+        --idx;
+    }
+    v.resize(std::max<size_t>(idx, 1));
+    BIGINT_PROFILE_END_UNFRAMED(carry, PROFILE_CARRY, 16 * v.size());
+}
+
+// Picks a kernel for two equal-length digit vectors: schoolbook at the bottom,
+// sequential Toom-3 in the middle and the parlay Toom-3 once the operands are
+// big enough to pay for intra-multiply parallelism. The parlay kernel is used
+// (rather than the OpenMP one) so that callers may themselves be inside par_do.
+static std::vector<long long> mul_balanced(const std::vector<long long>& x, const std::vector<long long>& y) {
+    size_t len = x.size();
+    if (len <= BASECASE_THRESHOLD) {
+        return naive_mul_vector(x, y);
+    }
+    if (len < PARALLEL_THRESHOLD) {
+        return toom_cook_mul_vector(x, y);
+    }
+    return par_toom_cook_mul_vector_plib(x, y);
+}
+
+// Multiplies two normalized digit vectors of arbitrary lengths and returns the
+// normalized product. A much longer operand is cut into chunks the size of the
+// shorter one so that no kernel runs on a mostly-zero padded input.
+std::vector<long long> mul_vector(const std::vector<long long>& x, const std::vector<long long>& y) {
+    const std::vector<long long>& big = x.size() >= y.size() ? x : y;
+    const std::vector<long long>& small = x.size() >= y.size() ? y : x;
+    size_t m = small.size();
+
+    if (m == 0) {
+        return {0};
+    }
+
+    std::vector<long long> res(big.size() + m + 1, 0);
+
+    if (big.size() < 2 * m) {
+        std::vector<long long> a(big);
+        std::vector<long long> b(small);
+        b.resize(a.size(), 0);
+        std::vector<long long> p = mul_balanced(a, b);
+        for (size_t i = 0; i < p.size() && i < res.size(); ++i) {
+            res[i] = p[i];
+        }
+        normalize_vector(res);
+        return res;
+    }
+
+    size_t chunks = (big.size() + m - 1) / m;
+    std::vector<std::vector<long long>> partial(chunks);
+    auto mul_chunk = [&](size_t c) {
+        if (cancellation_requested()) {
+            return;
+        }
+        size_t start = c * m;
+        size_t end = std::min(start + m, big.size());
+        std::vector<long long> piece(big.begin() + start, big.begin() + end);
+        piece.resize(m, 0);
+        partial[c] = mul_balanced(piece, small);
+    };
+
+    if (big.size() >= PARALLEL_THRESHOLD) {
+        bigint_parallel_for(0, chunks, mul_chunk, 1);
+    } else {
+        for (size_t c = 0; c < chunks; ++c) {
+            mul_chunk(c);
+        }
+    }
+
+    // Even chunks and odd chunks do not overlap each other, so each parity
+    // class can be accumulated without synchronization.
+    for (size_t parity = 0; parity < 2; ++parity) {
+        auto accumulate = [&](size_t h) {
+            size_t c = 2 * h + parity;
+            size_t offset = c * m;
+            for (size_t i = 0; i < partial[c].size() && offset + i < res.size(); ++i) {
+                res[offset + i] += partial[c][i];
+            }
+        };
+        size_t count = (chunks + 1 - parity) / 2;
+        if (big.size() >= PARALLEL_THRESHOLD) {
+            bigint_parallel_for(0, count, accumulate, 1);
+        } else {
+            for (size_t h = 0; h < count; ++h) {
+                accumulate(h);
+            }
+        }
+    }
+
+    normalize_vector(res);
+    return res;
+}
+
+// Work of an n-by-m product as mul_vector performs it: n / m Toom-3 products
+// of m-digit blocks, or schoolbook at the bottom. Only the order matters.
+double mul_vector_cost(size_t n, size_t m) {
+    if (n < m) std::swap(n, m);
+    if (m == 0) return 0;
+    double blocks = std::ceil(double(n) / double(m));
+    double block = m <= BASECASE_THRESHOLD ? double(m) * double(m) : std::pow(double(m), std::log(5.0) / std::log(3.0));
+    return blocks * block;
+}
+
+// Parses on the calling thread, unlike string_to_vector, whose OpenMP loop
+// would start a team of its own next to the parlay workers.
+static std::vector<long long> parse_sequential(const std::string& s) {
+    std::vector<long long> v(s.size());
+    for (size_t j = 0; j < s.size(); ++j) {
+        v[s.size() - 1 - j] = s[j] - '0';
+    }
+    normalize_vector(v);
+    return v;
+}
+
+std::string mul_decimal(const std::string& a, const std::string& b) {
+    std::vector<long long> product = mul_vector(parse_sequential(a), parse_sequential(b));
+    std::string s(product.size(), '0');
+    for (size_t j = 0; j < product.size(); ++j) {
+        s[product.size() - 1 - j] = char('0' + product[j]);
+    }
+    return s;
+}
+
+// Returns -1, 0 or 1 as x is less than, equal to or greater than y.
+int compare_vector(const std::vector<long long>& x, const std::vector<long long>& y) {
+    if (x.size() != y.size()) {
+        return x.size() < y.size() ? -1 : 1;
+    }
+    for (size_t i = x.size(); i-- > 0;) {
+        if (x[i] != y[i]) {
+            return x[i] < y[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+std::vector<long long> add_vector(const std::vector<long long>& x, const std::vector<long long>& y) {
+    std::vector<long long> res(std::max(x.size(), y.size()) + 1, 0);
+    long long carry = 0;
+    for (size_t i = 0; i < res.size(); ++i) {
+        long long cur = carry;
+        if (i < x.size()) cur += x[i];
+        if (i < y.size()) cur += y[i];
+        carry = cur >= 10;
+        res[i] = cur - 10 * carry;
+    }
+    normalize_vector(res);
+    return res;
+}
+
+// Requires x >= y.
+std::vector<long long> sub_vector(const std::vector<long long>& x, const std::vector<long long>& y) {
+    std::vector<long long> res(x.size(), 0);
+    long long borrow = 0;
+    for (size_t i = 0; i < res.size(); ++i) {
+        long long cur = x[i] - borrow - (i < y.size() ? y[i] : 0);
+        borrow = cur < 0;
+        res[i] = cur + 10 * borrow;
+    }
+    normalize_vector(res);
+    return res;
+}
+
+// Multiplies by 10^n.
+std::vector<long long> shift_vector(const std::vector<long long>& x, size_t n) {
+    if (x.size() == 1 && x[0] == 0) {
+        return x;
+    }
+    std::vector<long long> res(n, 0);
+    res.insert(res.end(), x.begin(), x.end());
+    return res;
+}
+
+// Divides by 10^n, discarding the remainder.
+std::vector<long long> shift_down_vector(const std::vector<long long>& x, size_t n) {
+    if (n >= x.size()) {
+        return {0};
+    }
+    return std::vector<long long>(x.begin() + n, x.end());
+}
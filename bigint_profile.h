@@ -0,0 +1,146 @@
+#ifndef BIGINT_PROFILE_H
+#define BIGINT_PROFILE_H
+
+// Recursion-level profiler for the divide-and-conquer kernels. It is compiled
+// in only with -DBIGINT_PROFILE (make PROFILE=1); otherwise every hook below
+// expands to nothing, or to the plain parlay call, and costs nothing.
+// bigint_par_do also goes through the task tracer in bigint_trace.h.
+//
+// A kernel opens a frame per recursive call and times its phases inside it.
+// Counters are kept per thread (parlay::ThreadSpecific) and indexed by the
+// recursion depth. The depth is handed explicitly to spawned branches, so a
+// branch keeps its depth even when another worker runs it. Time spent waiting
+// at a join is the join's wall time minus the branches the waiting thread ran
+// itself in the meantime.
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <utility>
+
+#include "parlaylib/include/parlay/parallel.h"
+
+#include "bigint_trace.h"
+
+enum profile_phase {
+    PROFILE_BASECASE,
+    PROFILE_EVALUATE,
+    PROFILE_INTERPOLATE,
+    PROFILE_CARRY,
+    PROFILE_JOIN,
+    PROFILE_NUM_PHASES,
+};
+
+// Clears the counters of all threads / prints the per-depth breakdown of
+// everything recorded since. Both do nothing without BIGINT_PROFILE.
+void profile_reset();
+void profile_report(std::ostream& out);
+
+#ifdef BIGINT_PROFILE
+
+using profile_clock = std::chrono::steady_clock;
+
+size_t& profile_current_depth();
+double& profile_task_seconds();
+void profile_record(size_t depth, profile_phase phase, double seconds, size_t bytes);
+void profile_record_call(size_t depth, size_t length, double seconds, size_t bytes);
+
+inline double profile_seconds_since(profile_clock::time_point start) {
+    return std::chrono::duration<double>(profile_clock::now() - start).count();
+}
+
+// Depth of the innermost open frame on this thread.
+inline size_t profile_phase_depth() {
+    size_t d = profile_current_depth();
+    return d > 0 ? d - 1 : 0;
+}
+
+// One recursive call: counts the call and its inclusive time at its depth.
+class profile_frame {
+public:
+    profile_frame(size_t length, size_t bytes)
+        : length(length), bytes(bytes), level(profile_current_depth()++), start(profile_clock::now()) {}
+    ~profile_frame() {
+        --profile_current_depth();
+        profile_record_call(level, length, profile_seconds_since(start), bytes);
+    }
+    profile_frame(const profile_frame&) = delete;
+    profile_frame& operator=(const profile_frame&) = delete;
+
+    size_t depth() const { return level; }
+
+private:
+    size_t length;
+    size_t bytes;
+    size_t level;
+    profile_clock::time_point start;
+};
+
+// Runs f as a branch spawned from depth - 1, on whichever thread executes it.
+template <typename F>
+void profile_task(size_t depth, F&& f) {
+    size_t saved_depth = profile_current_depth();
+    double before = profile_task_seconds();
+    profile_current_depth() = depth;
+    auto start = profile_clock::now();
+    f();
+    // Replaces whatever nested branches added, so that a join only subtracts
+    // the outermost branches its thread ran while waiting.
+    profile_task_seconds() = before + profile_seconds_since(start);
+    profile_current_depth() = saved_depth;
+}
+
+struct profile_join_mark {
+    profile_clock::time_point start;
+    double task_seconds;
+};
+
+inline profile_join_mark profile_join_start() {
+    return {profile_clock::now(), profile_task_seconds()};
+}
+
+inline void profile_join_end(const profile_join_mark& mark, size_t depth) {
+    double waited = profile_seconds_since(mark.start) - (profile_task_seconds() - mark.task_seconds);
+    profile_record(depth, PROFILE_JOIN, waited > 0 ? waited : 0, 0);
+}
+
+#define BIGINT_PROFILE_FRAME(length, bytes) profile_frame bigint_profile_frame_(length, bytes)
+#define BIGINT_PROFILE_BEGIN(name) auto bigint_profile_##name = profile_clock::now()
+// Phases are recorded at the depth of the enclosing frame, which is right even
+// inside an OpenMP task that another thread runs.
+#define BIGINT_PROFILE_END(name, phase, bytes) \
+    profile_record(bigint_profile_frame_.depth(), phase, profile_seconds_since(bigint_profile_##name), bytes)
+// For code outside any kernel frame, such as the final carry.
+#define BIGINT_PROFILE_END_UNFRAMED(name, phase, bytes) \
+    profile_record(profile_phase_depth(), phase, profile_seconds_since(bigint_profile_##name), bytes)
+#define BIGINT_PROFILE_JOIN_BEGIN(name) auto bigint_profile_##name = profile_join_start()
+#define BIGINT_PROFILE_JOIN_END(name) profile_join_end(bigint_profile_##name, bigint_profile_frame_.depth())
+// Body of an OpenMP task spawned from the current frame.
+#define BIGINT_PROFILE_TASK(...) profile_task(bigint_profile_frame_.depth() + 1, [&]() { __VA_ARGS__; })
+
+template <typename L, typename R>
+inline void bigint_par_do(L&& left, R&& right) {
+    size_t depth = profile_current_depth();
+    profile_join_mark mark = profile_join_start();
+    trace_par_do([&]() { profile_task(depth, left); }, [&]() { profile_task(depth, right); });
+    profile_join_end(mark, depth > 0 ? depth - 1 : 0);
+}
+
+#else
+
+#define BIGINT_PROFILE_FRAME(length, bytes)
+#define BIGINT_PROFILE_BEGIN(name)
+#define BIGINT_PROFILE_END(name, phase, bytes)
+#define BIGINT_PROFILE_END_UNFRAMED(name, phase, bytes)
+#define BIGINT_PROFILE_JOIN_BEGIN(name)
+#define BIGINT_PROFILE_JOIN_END(name)
+#define BIGINT_PROFILE_TASK(...) __VA_ARGS__
+
+template <typename L, typename R>
+inline void bigint_par_do(L&& left, R&& right) {
+    trace_par_do(std::forward<L>(left), std::forward<R>(right));
+}
+
+#endif
+
+#endif // BIGINT_PROFILE_H
@@ -0,0 +1,149 @@
+#ifndef BIGINT_TRACE_H
+#define BIGINT_TRACE_H
+
+// Task tracer for the parallel kernels. It is compiled in only with
+// -DBIGINT_TRACE (make TRACE=1); otherwise the hooks below are the plain
+// parlay calls or expand to nothing.
+//
+// Every traced branch records which worker ran it, when, and which worker
+// spawned it. A branch run by a worker other than its spawner was stolen.
+// trace_write emits the events as Chrome trace-event JSON. Tasks become
+// complete ("X") events on their worker's row, and each steal becomes a
+// flow arrow from the spawning worker to the thief. Workers are numbered per
+// OS thread, so parlay workers and OpenMP threads share one numbering.
+//
+// Our own spawn sites are traced: bigint_par_do, bigint_parallel_for, and
+// the OpenMP tasks and sections in the kernels. Scheduler internals and
+// OpenMP worksharing loops are not. GCC's libgomp does not implement OMPT,
+// so OpenMP tasks are marked by hand at the spawn site.
+//
+// The wrappers also hand the spawning thread's cancellation token
+// (bigint_cancel.h) to every branch. This costs nothing outside async_multiply.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+
+#include "parlaylib/include/parlay/parallel.h"
+
+#include "bigint_cancel.h"
+
+// Drops all recorded events and restarts the clock.
+void trace_reset();
+// Events recorded from now on go into a new process row named name, so runs
+// of several algorithms can share one trace file.
+void trace_process(const std::string& name);
+// Writes everything recorded so far as Chrome trace-event JSON.
+void trace_write(std::ostream& out);
+
+#ifdef BIGINT_TRACE
+
+struct trace_spawn {
+    uint32_t worker;
+    double time;  // microseconds since trace_reset
+};
+
+uint32_t trace_worker();
+double trace_now();
+void trace_record(const char* name, const trace_spawn& spawn, double begin, double end);
+
+inline trace_spawn trace_spawn_point() {
+    return {trace_worker(), trace_now()};
+}
+
+// Runs f as a task spawned at spawn, on whichever thread executes it.
+template <typename F>
+void trace_task(const char* name, const trace_spawn& spawn, F&& f) {
+    double begin = trace_now();
+    f();
+    trace_record(name, spawn, begin, trace_now());
+}
+
+// Records the enclosing block as a task spawned at spawn.
+class trace_scope {
+public:
+    trace_scope(const char* name, const trace_spawn& spawn) : name(name), spawn(spawn), begin(trace_now()) {}
+    ~trace_scope() { trace_record(name, spawn, begin, trace_now()); }
+    trace_scope(const trace_scope&) = delete;
+    trace_scope& operator=(const trace_scope&) = delete;
+
+private:
+    const char* name;
+    trace_spawn spawn;
+    double begin;
+};
+
+template <typename L, typename R>
+inline void trace_par_do(L&& left, R&& right) {
+    trace_spawn spawn = trace_spawn_point();
+    const cancellation_token* token = cancellation_current();
+    parlay::par_do([&]() { cancellation_scope scope(token); trace_task("par_do", spawn, left); },
+                   [&]() { cancellation_scope scope(token); trace_task("par_do", spawn, right); });
+}
+
+// Traced parallel_for. One event per block, not per iteration. Without an
+// explicit granularity, the range is cut into 8 blocks per worker.
+template <typename F>
+inline void bigint_parallel_for(size_t start, size_t end, F&& f, long granularity = 0) {
+    if (end <= start) {
+        return;
+    }
+    trace_spawn spawn = trace_spawn_point();
+    size_t n = end - start;
+    size_t block = granularity > 0 ? size_t(granularity) : std::max<size_t>(1, n / (8 * parlay::num_workers()));
+    size_t blocks = (n + block - 1) / block;
+    const cancellation_token* token = cancellation_current();
+    parlay::parallel_for(0, blocks, [&](size_t b) {
+        cancellation_scope scope(token);
+        trace_task("parallel_for", spawn, [&]() {
+            size_t lo = start + b * block;
+            size_t hi = std::min(lo + block, end);
+            for (size_t i = lo; i < hi; ++i) {
+                f(i);
+            }
+        });
+    }, 1);
+}
+
+#define BIGINT_TRACE_SPAWN(name) trace_spawn bigint_trace_##name = trace_spawn_point()
+// Body of an OpenMP task or section created after BIGINT_TRACE_SPAWN(name).
+#define BIGINT_TRACE_TASK(label, name, ...) trace_task(label, bigint_trace_##name, [&]() { __VA_ARGS__; })
+// The same for the rest of the enclosing block.
+#define BIGINT_TRACE_SCOPE(label, name) trace_scope bigint_trace_scope_##name(label, bigint_trace_##name)
+// A span on the current thread, e.g. a whole multiplication.
+#define BIGINT_TRACE_SPAN(label, ...) trace_task(label, trace_spawn_point(), [&]() { __VA_ARGS__; })
+
+#else
+
+template <typename L, typename R>
+inline void trace_par_do(L&& left, R&& right) {
+    const cancellation_token* token = cancellation_current();
+    if (token == nullptr) {
+        parlay::par_do(std::forward<L>(left), std::forward<R>(right));
+        return;
+    }
+    parlay::par_do([&]() { cancellation_scope scope(token); left(); },
+                   [&]() { cancellation_scope scope(token); right(); });
+}
+
+template <typename F>
+inline void bigint_parallel_for(size_t start, size_t end, F&& f, long granularity = 0) {
+    const cancellation_token* token = cancellation_current();
+    if (token == nullptr) {
+        parlay::parallel_for(start, end, std::forward<F>(f), granularity);
+        return;
+    }
+    parlay::parallel_for(start, end, [&](size_t i) { cancellation_scope scope(token); f(i); }, granularity);
+}
+
+#define BIGINT_TRACE_SPAWN(name)
+#define BIGINT_TRACE_TASK(label, name, ...) __VA_ARGS__
+#define BIGINT_TRACE_SCOPE(label, name)
+#define BIGINT_TRACE_SPAN(label, ...) __VA_ARGS__
+
+#endif
+
+#endif // BIGINT_TRACE_H
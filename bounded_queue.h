@@ -0,0 +1,49 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <queue>
+
+// Blocks the producer while full and the consumer while empty. pop() returns
+// nothing once the queue is closed and drained.
+template <typename T>
+class bounded_queue {
+public:
+    explicit bounded_queue(size_t capacity) : capacity(capacity) {}
+
+    void push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [&] { return items.size() < capacity; });
+        items.push(std::move(item));
+        not_empty.notify_one();
+    }
+
+    std::optional<T> pop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [&] { return !items.empty() || closed; });
+        if (items.empty()) {
+            return std::nullopt;
+        }
+        T item = std::move(items.front());
+        items.pop();
+        not_full.notify_one();
+        return item;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        not_empty.notify_all();
+    }
+
+private:
+    size_t capacity;
+    std::queue<T> items;
+    bool closed = false;
+    std::mutex mutex;
+    std::condition_variable not_full, not_empty;
+};
+
+#endif // BOUNDED_QUEUE_H
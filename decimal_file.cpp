@@ -0,0 +1,131 @@
+#include "bigint_multiply.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "parlaylib/include/parlay/io.h"
+#include "parlaylib/include/parlay/parallel.h"
+
+static constexpr size_t PARSE_BLOCK_SIZE = 1 << 16;
+static constexpr size_t WRITE_CHUNK_SIZE = 1 << 20;
+
+static std::runtime_error file_error(const std::string& path, const std::string& what) {
+    return std::runtime_error(path + ": " + what);
+}
+
+// parlay::file_map only asserts on failure and cannot map an empty file, so
+// both cases are checked first.
+decimal_file::decimal_file(const std::string& path) {
+    struct stat sb;
+    if (stat(path.c_str(), &sb) != 0) {
+        throw file_error(path, std::strerror(errno));
+    }
+    if (!S_ISREG(sb.st_mode)) {
+        throw file_error(path, "not a regular file");
+    }
+    if (sb.st_size == 0) {
+        throw file_error(path, "empty file");
+    }
+
+    map = std::make_unique<parlay::file_map>(path);
+    first = map->begin();
+    last = map->end();
+    while (first != last && std::isspace(static_cast<unsigned char>(*first))) ++first;
+    if (first != last && *first == '+') ++first;
+    while (last != first && std::isspace(static_cast<unsigned char>(last[-1]))) --last;
+    if (first == last) {
+        throw file_error(path, "no digits");
+    }
+
+    // Offset of the first non-digit in each block, or the block size.
+    size_t n = last - first;
+    size_t blocks = (n + PARSE_BLOCK_SIZE - 1) / PARSE_BLOCK_SIZE;
+    std::vector<size_t> bad(blocks);
+    parlay::parallel_for(0, blocks, [&](size_t b) {
+        size_t lo = b * PARSE_BLOCK_SIZE;
+        size_t hi = std::min(lo + PARSE_BLOCK_SIZE, n);
+        size_t i = lo;
+        while (i < hi && first[i] >= '0' && first[i] <= '9') ++i;
+        bad[b] = i;
+    }, 1);
+    for (size_t b = 0; b < blocks; ++b) {
+        if (bad[b] < std::min((b + 1) * PARSE_BLOCK_SIZE, n)) {
+            throw file_error(path, "invalid character at offset " + std::to_string(first - map->begin() + bad[b]));
+        }
+    }
+}
+
+decimal_file::~decimal_file() = default;
+decimal_file::decimal_file(decimal_file&&) noexcept = default;
+decimal_file& decimal_file::operator=(decimal_file&&) noexcept = default;
+
+size_t decimal_file::size() const {
+    return last - first;
+}
+
+// Reads straight out of the mapped pages into the digit vector, so the text
+// is never copied into a std::string.
+std::vector<long long> decimal_file::digits(size_t length) const {
+    size_t n = size();
+    std::vector<long long> res(std::max(n, length), 0);
+    parlay::parallel_for(0, n, [&](size_t i) {
+        res[n - 1 - i] = first[i] - '0';
+    });
+    return res;
+}
+
+// Each chunk of the output is formatted into its own buffer and written at
+// its final offset, so chunks are formatted and written concurrently.
+void write_decimal_file(const std::string& path, const std::vector<long long>& digits) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw file_error(path, std::strerror(errno));
+    }
+
+    size_t n = digits.size();
+    size_t total = n + 1;  // trailing newline
+    if (ftruncate(fd, total) != 0) {
+        int err = errno;
+        close(fd);
+        throw file_error(path, std::strerror(err));
+    }
+
+    size_t chunks = (total + WRITE_CHUNK_SIZE - 1) / WRITE_CHUNK_SIZE;
+    std::vector<int> errors(chunks, 0);
+    parlay::parallel_for(0, chunks, [&](size_t c) {
+        size_t lo = c * WRITE_CHUNK_SIZE;
+        size_t hi = std::min(lo + WRITE_CHUNK_SIZE, total);
+        std::string buffer(hi - lo, '\n');
+        for (size_t pos = lo; pos < std::min(hi, n); ++pos) {
+            buffer[pos - lo] = char('0' + digits[n - 1 - pos]);
+        }
+        size_t done = 0;
+        while (done < buffer.size()) {
+            ssize_t w = pwrite(fd, buffer.data() + done, buffer.size() - done, lo + done);
+            if (w < 0) {
+                if (errno == EINTR) continue;
+                errors[c] = errno;
+                return;
+            }
+            done += w;
+        }
+    }, 1);
+
+    int close_result = close(fd);
+    for (int err : errors) {
+        if (err != 0) {
+            throw file_error(path, std::strerror(err));
+        }
+    }
+    if (close_result != 0) {
+        throw file_error(path, std::strerror(errno));
+    }
+}
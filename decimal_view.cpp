@@ -0,0 +1,121 @@
+#include "bigint_multiply.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+
+static constexpr size_t TRUNCATE_THRESHOLD = 100;
+
+decimal_view::decimal_view(std::vector<long long> coefficients) : coeffs(std::move(coefficients)) {
+    size_t n = coeffs.size();
+    while (n > 1 && coeffs[n - 1] == 0) {
+        --n;
+    }
+    coeffs.resize(std::max<size_t>(n, 1));
+}
+
+// Exact digits of the value from position offset upward, with at least k of
+// them. Only the top k + guard coefficients are carried. Coefficients of a
+// product of digit vectors are below 81 * |coeffs|, so the carry arriving from
+// the untouched coefficients is below 9 * |coeffs| units of the lowest carried
+// position, and unless the guard digits are within that
+// bound of overflowing, the digits above the guard are already final. In the
+// rare case they are not, the carry from below is computed exactly.
+decimal_view::top_digits decimal_view::top(size_t k) const {
+    size_t n = coeffs.size();
+    size_t guard = std::to_string(9 * n).size() + 3;
+    size_t start = n > k + guard ? n - k - guard : 0;
+
+    std::vector<long long> window(coeffs.begin() + start, coeffs.end());
+    if (start == 0) {
+        normalize_vector(window);
+        return {0, window};
+    }
+
+    normalize_vector(window);
+    long long low = 0;
+    for (size_t i = guard; i-- > 0;) {
+        low = low * 10 + (i < window.size() ? window[i] : 0);
+    }
+
+    long long limit = 1;
+    for (size_t i = 0; i < guard; ++i) {
+        limit *= 10;
+    }
+
+    if (low + static_cast<long long>(9 * n) < limit) {
+        return {start + guard, shift_down_vector(window, guard)};
+    }
+
+    long long carry = 0;
+    for (size_t i = 0; i < start; ++i) {
+        carry = (carry + coeffs[i]) / 10;
+    }
+    window.assign(coeffs.begin() + start, coeffs.end());
+    window[0] += carry;
+    normalize_vector(window);
+    return {start, window};
+}
+
+size_t decimal_view::size() const {
+    top_digits t = top(1);
+    return t.offset + t.digits.size();
+}
+
+std::string decimal_view::head(size_t k) const {
+    top_digits t = top(k);
+    std::string s;
+    for (size_t i = t.digits.size(); i-- > 0 && s.size() < k;) {
+        s.push_back(char('0' + t.digits[i]));
+    }
+    return s;
+}
+
+// Carries never move downward, so the low k digits only depend on the low k
+// coefficients.
+std::string decimal_view::tail(size_t k) const {
+    std::vector<long long> low(coeffs.begin(), coeffs.begin() + std::min(k, coeffs.size()));
+    long long carry = 0;
+    for (auto& c : low) {
+        c += carry;
+        carry = c / 10;
+        c %= 10;
+    }
+    while (carry > 0 && low.size() < k) {
+        low.push_back(carry % 10);
+        carry /= 10;
+    }
+
+    size_t len = std::min(k, size());
+    std::string s(len, '0');
+    for (size_t i = 0; i < len && i < low.size(); ++i) {
+        s[len - 1 - i] = char('0' + low[i]);
+    }
+    return s;
+}
+
+std::string decimal_view::truncated(size_t head_len, size_t tail_len) const {
+    if (size() <= TRUNCATE_THRESHOLD) {
+        return str();
+    }
+    return head(head_len) + "..." + tail(tail_len);
+}
+
+std::string decimal_view::str() const {
+    std::vector<long long> d = digits();
+    std::string s(d.size(), '0');
+    for (size_t i = 0; i < d.size(); ++i) {
+        s[d.size() - 1 - i] = char('0' + d[i]);
+    }
+    return s;
+}
+
+std::vector<long long> decimal_view::digits() const {
+    std::vector<long long> d(coeffs);
+    normalize_vector(d);
+    return d;
+}
+
+// The value modulo p, reduced straight from the coefficients.
+uint64_t decimal_view::residue(uint64_t p) const {
+    return residue_vector(coeffs, p);
+}
@@ -0,0 +1,222 @@
+#include "bigint_multiply.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+
+using BigInt = std::vector<long long>;
+
+static constexpr size_t DIVISION_BASECASE_THRESHOLD = 32;
+static constexpr size_t NEWTON_GUARD_DIGITS = 3;
+
+// Long division, one quotient digit at a time. Used when the quotient or the
+// divisor is short and for the bottom of the Newton recursion.
+static std::pair<BigInt, BigInt> schoolbook_divmod(const BigInt &a, const BigInt &b) {
+    BigInt q(a.size(), 0);
+    BigInt r = {0};
+
+    for (size_t i = a.size(); i-- > 0;) {
+        if (r.size() == 1 && r[0] == 0) {
+            r[0] = a[i];
+        } else {
+            r.insert(r.begin(), a[i]);
+        }
+
+        long long digit = 0;
+        while (compare_vector(r, b) >= 0) {
+            long long borrow = 0;
+            for (size_t j = 0; j < r.size(); ++j) {
+                long long cur = r[j] - borrow - (j < b.size() ? b[j] : 0);
+                borrow = cur < 0;
+                r[j] = cur + 10 * borrow;
+            }
+            normalize_vector(r);
+            ++digit;
+        }
+        q[i] = digit;
+    }
+
+    normalize_vector(q);
+    return {q, r};
+}
+
+// Enough extra low digits that the carry out of the skipped coefficients of an
+// n-coefficient product changes the kept part by less than one unit.
+static size_t carry_guard_digits(size_t n) {
+    size_t digits = 1;
+    for (size_t bound = 81 * n; bound > 0; bound /= 10) {
+        ++digits;
+    }
+    return digits;
+}
+
+// Coefficients lo..lo+n-1 of x * y for |y| <= n, as one middle product. The
+// coefficients below lo are never formed, so the window is only correct up to
+// their carry.
+static BigInt product_window(const BigInt &x, const BigInt &y, long long lo, size_t n) {
+    BigInt yy(y);
+    yy.resize(n, 0);
+
+    BigInt xx(2 * n - 1, 0);
+    long long first = lo - static_cast<long long>(n - 1);
+    for (size_t i = 0; i < xx.size(); ++i) {
+        long long idx = first + static_cast<long long>(i);
+        if (idx >= 0 && idx < static_cast<long long>(x.size())) {
+            xx[i] = x[idx];
+        }
+    }
+
+    return karatsuba_middle_product_vector(xx, yy);
+}
+
+// floor(x * y / 10^shift) up to a small additive error, forming only the
+// product digits at and above shift (less a guard).
+static BigInt mul_high(const BigInt &x, const BigInt &y, size_t shift) {
+    const BigInt &longer = x.size() >= y.size() ? x : y;
+    const BigInt &shorter = x.size() >= y.size() ? y : x;
+    size_t top = x.size() + y.size();
+    if (shift >= top) {
+        return {0};
+    }
+
+    size_t n = std::max(top - shift, shorter.size());
+    size_t guard = std::min(carry_guard_digits(n), shift);
+    BigInt window = product_window(longer, shorter, static_cast<long long>(shift - guard), n + guard);
+    normalize_vector(window);
+    return shift_down_vector(window, guard);
+}
+
+// Approximates 10^(2k) / b for a k-digit b. Each level solves the problem for
+// the top h ~ k/2 digits of b, giving xh ~ 10^(2h) / bh, and then applies one
+// Newton step
+//     x = xh * 10^(k-h) + xh * (10^(k+h) - b * xh) / 10^(2h),
+// which doubles the number of correct digits. Since b * xh agrees with
+// 10^(k+h) in its leading digits, only a middle window of that product is
+// formed. The result may be off by a few units; callers correct it against
+// the exact remainder.
+static BigInt approx_reciprocal(const BigInt &b) {
+    size_t k = b.size();
+
+    if (k <= DIVISION_BASECASE_THRESHOLD) {
+        return schoolbook_divmod(shift_vector({1}, 2 * k), b).first;
+    }
+
+    size_t h = (k + 1) / 2 + NEWTON_GUARD_DIGITS;
+    BigInt xh = approx_reciprocal(shift_down_vector(b, k - h));
+    BigInt x0 = shift_vector(xh, k - h);
+
+    // The residual 10^(k+h) - b * xh is below 10^(k + guard), and only its
+    // digits from about h upward reach the result.
+    size_t guard = carry_guard_digits(k);
+    size_t lo = h > guard ? h - guard : 0;
+    size_t n = std::max(k + NEWTON_GUARD_DIGITS + 1 - lo, xh.size());
+
+    BigInt v = product_window(b, xh, static_cast<long long>(lo), n);
+    normalize_vector(v);
+    if (v.size() > n) {
+        v.resize(n);
+        normalize_vector(v);
+    }
+
+    // v ~ (b * xh mod 10^(lo+n)) / 10^lo, and 10^(k+h) vanishes modulo 10^(lo+n),
+    // so a small v means b * xh overshoots and a v close to 10^n undershoots.
+    BigInt half = shift_vector({5}, n - 1);
+    if (compare_vector(v, half) >= 0) {
+        BigInt e = sub_vector(shift_vector({1}, n), v);
+        return add_vector(x0, mul_high(xh, e, 2 * h - lo));
+    }
+
+    BigInt correction = add_vector(mul_high(xh, v, 2 * h - lo), {1});
+    if (compare_vector(correction, x0) >= 0) {
+        return {1};
+    }
+    return sub_vector(x0, correction);
+}
+
+// Quotient and remainder of a / b. Short quotients and divisors use long
+// division; otherwise we multiply the leading digits of a by a Newton reciprocal of the leading
+// digits of b, so the cost is a few multiplications of quotient-sized numbers
+// plus one quotient-by-divisor product to recover the remainder.
+std::pair<BigInt, BigInt> divmod_vector(const BigInt &a, const BigInt &b) {
+    if (b.size() == 1 && b[0] == 0) {
+        throw std::invalid_argument("Division by zero");
+    }
+    if (compare_vector(a, b) < 0) {
+        return {{0}, a};
+    }
+
+    size_t m = a.size() - b.size() + 1;
+    if (m <= DIVISION_BASECASE_THRESHOLD || b.size() <= DIVISION_BASECASE_THRESHOLD) {
+        return schoolbook_divmod(a, b);
+    }
+
+    // A quotient much longer than the divisor is produced one divisor-sized
+    // block at a time, so every step is a balanced 2n-by-n division.
+    if (m > 2 * b.size()) {
+        size_t n = b.size();
+        BigInt q(a.size(), 0);
+        BigInt r = {0};
+        for (size_t blk = (a.size() + n - 1) / n; blk-- > 0;) {
+            size_t start = blk * n;
+            size_t end = std::min(start + n, a.size());
+            BigInt chunk(a.begin() + start, a.begin() + end);
+            normalize_vector(chunk);
+
+            auto [qb, rb] = divmod_vector(add_vector(shift_vector(r, end - start), chunk), b);
+            for (size_t i = 0; i < qb.size(); ++i) {
+                q[start + i] = qb[i];
+            }
+            r = rb;
+        }
+        normalize_vector(q);
+        return {q, r};
+    }
+
+    // Only the leading m + guard digits of each operand influence the quotient
+    // beyond a small additive error. A divisor shorter than that is padded
+    // with low zeros so the reciprocal still carries enough digits.
+    size_t k = m + NEWTON_GUARD_DIGITS;
+    BigInt bt = b.size() >= k ? shift_down_vector(b, b.size() - k) : shift_vector(b, k - b.size());
+    size_t a_drop = a.size() > m + k + NEWTON_GUARD_DIGITS ? a.size() - (m + k + NEWTON_GUARD_DIGITS) : 0;
+
+    // b ~ bt * 10^(b.size() - k) and x ~ 10^(2k) / bt
+    BigInt x = approx_reciprocal(bt);
+    BigInt q = mul_high(shift_down_vector(a, a_drop), x, k + b.size() - a_drop);
+
+    BigInt p = mul_vector(q, b);
+    while (compare_vector(p, a) > 0) {
+        p = sub_vector(p, b);
+        q = sub_vector(q, {1});
+    }
+    BigInt r = sub_vector(a, p);
+    while (compare_vector(r, b) >= 0) {
+        r = sub_vector(r, b);
+        q = add_vector(q, {1});
+    }
+
+    return {q, r};
+}
+
+// floor(10^precision / b)
+BigInt reciprocal_vector(const BigInt &b, size_t precision) {
+    return divmod_vector(shift_vector({1}, precision), b).first;
+}
+
+static BigInt parse_operand(const std::string &s) {
+    BigInt v = string_to_vector(s);
+    normalize_vector(v);
+    return v;
+}
+
+std::pair<std::string, std::string> divmod_string(const std::string &a, const std::string &b) {
+    auto [q, r] = divmod_vector(parse_operand(a), parse_operand(b));
+    return {vector_to_string(q), vector_to_string(r)};
+}
+
+std::string div_string(const std::string &a, const std::string &b) {
+    return divmod_string(a, b).first;
+}
+
+std::string mod_string(const std::string &a, const std::string &b) {
+    return divmod_string(a, b).second;
+}
@@ -0,0 +1,187 @@
+#include "bigint_multiply.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "parlaylib/include/parlay/io.h"
+#include "parlaylib/include/parlay/parallel.h"
+
+#include "limb_format.h"
+
+static constexpr size_t CHECKSUM_BLOCK_SIZE = 1 << 14;
+static constexpr size_t WRITE_CHUNK_SIZE = 1 << 20;
+
+static std::runtime_error file_error(const std::string& path, const std::string& what) {
+    return std::runtime_error(path + ": " + what);
+}
+
+// splitmix64's finalizer
+static uint64_t mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Sum over i of mix(limb[i] + i * golden ratio). Each term depends on the
+// position, so swapped limbs are caught, and the sum splits into blocks that
+// are hashed in parallel.
+uint64_t limb_checksum(const long long* limbs, size_t n, size_t first_index) {
+    size_t blocks = (n + CHECKSUM_BLOCK_SIZE - 1) / CHECKSUM_BLOCK_SIZE;
+    std::vector<uint64_t> partial(blocks);
+    parlay::parallel_for(0, blocks, [&](size_t b) {
+        size_t start = b * CHECKSUM_BLOCK_SIZE;
+        size_t end = std::min(start + CHECKSUM_BLOCK_SIZE, n);
+        uint64_t h = 0;
+        for (size_t i = start; i < end; ++i) {
+            h += mix(static_cast<uint64_t>(limbs[i]) + (first_index + i) * 0x9e3779b97f4a7c15ULL);
+        }
+        partial[b] = h;
+    }, 1);
+
+    uint64_t h = 0;
+    for (uint64_t p : partial) {
+        h += p;
+    }
+    return h;
+}
+
+limb_file_header make_limb_header(const long long* limbs, size_t n, bool negative, uint64_t base) {
+    limb_file_header header = {};
+    std::memcpy(header.magic, LIMB_FILE_MAGIC, sizeof(LIMB_FILE_MAGIC));
+    header.version = LIMB_FILE_VERSION;
+    header.limb_bytes = sizeof(long long);
+    header.base = base;
+    header.count = n;
+    header.checksum = limb_checksum(limbs, n);
+    header.negative = negative;
+    return header;
+}
+
+std::string limb_header_error(const limb_file_header& header, size_t available) {
+    if (std::memcmp(header.magic, LIMB_FILE_MAGIC, sizeof(LIMB_FILE_MAGIC)) != 0) {
+        return "not a limb file";
+    }
+    if (header.version != LIMB_FILE_VERSION) {
+        return "unsupported limb file version " + std::to_string(header.version);
+    }
+    if (header.limb_bytes != sizeof(long long)) {
+        return "unsupported limb size " + std::to_string(header.limb_bytes);
+    }
+    if (header.base < 2) {
+        return "invalid base " + std::to_string(header.base);
+    }
+    if (header.count > available / sizeof(long long)) {
+        return "truncated: header says " + std::to_string(header.count) + " limbs";
+    }
+    return "";
+}
+
+bool limb_file::matches(const std::string& path) {
+    char magic[sizeof(LIMB_FILE_MAGIC)] = {};
+    std::ifstream in(path, std::ios::binary);
+    in.read(magic, sizeof(magic));
+    return in && std::memcmp(magic, LIMB_FILE_MAGIC, sizeof(magic)) == 0;
+}
+
+// Only the header is read here; the limbs are used where they were mapped.
+limb_file::limb_file(const std::string& path) {
+    struct stat sb;
+    if (stat(path.c_str(), &sb) != 0) {
+        throw file_error(path, std::strerror(errno));
+    }
+    if (!S_ISREG(sb.st_mode)) {
+        throw file_error(path, "not a regular file");
+    }
+    if (static_cast<size_t>(sb.st_size) < sizeof(limb_file_header)) {
+        throw file_error(path, "too short for a limb file header");
+    }
+
+    map = std::make_unique<parlay::file_map>(path);
+    limb_file_header header;
+    std::memcpy(&header, map->begin(), sizeof(header));
+
+    std::string error = limb_header_error(header, map->size() - sizeof(header));
+    if (!error.empty()) {
+        throw file_error(path, error);
+    }
+
+    limbs = reinterpret_cast<const long long*>(map->begin() + sizeof(header));
+    count = header.count;
+    limb_base = header.base;
+    sign = header.negative != 0;
+    expected_checksum = header.checksum;
+}
+
+limb_file::~limb_file() = default;
+limb_file::limb_file(limb_file&&) noexcept = default;
+limb_file& limb_file::operator=(limb_file&&) noexcept = default;
+
+bool limb_file::verify() const {
+    return limb_checksum(limbs, count) == expected_checksum;
+}
+
+std::vector<long long> limb_file::to_vector(size_t length) const {
+    std::vector<long long> res(std::max(count, length), 0);
+    parlay::parallel_for(0, count, [&](size_t i) { res[i] = limbs[i]; });
+    return res;
+}
+
+// The header and the limbs go straight from memory to their offsets in the
+// file; 1 MiB chunks of limbs are written concurrently.
+void write_limb_file(const std::string& path, const long long* limbs, size_t n, bool negative, uint64_t base) {
+    if (base < 2) {
+        throw std::invalid_argument(path + ": invalid base " + std::to_string(base));
+    }
+    limb_file_header header = make_limb_header(limbs, n, negative, base);
+
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw file_error(path, std::strerror(errno));
+    }
+
+    size_t bytes = n * sizeof(long long);
+    size_t chunks = (bytes + WRITE_CHUNK_SIZE - 1) / WRITE_CHUNK_SIZE;
+    std::vector<int> errors(chunks + 1, 0);
+    auto write_all = [&](const char* p, size_t len, size_t offset, int& error) {
+        size_t done = 0;
+        while (done < len) {
+            ssize_t w = pwrite(fd, p + done, len - done, offset + done);
+            if (w < 0) {
+                if (errno == EINTR) continue;
+                error = errno;
+                return;
+            }
+            done += w;
+        }
+    };
+
+    write_all(reinterpret_cast<const char*>(&header), sizeof(header), 0, errors[chunks]);
+    const char* data = reinterpret_cast<const char*>(limbs);
+    parlay::parallel_for(0, chunks, [&](size_t c) {
+        size_t lo = c * WRITE_CHUNK_SIZE;
+        size_t len = std::min(WRITE_CHUNK_SIZE, bytes - lo);
+        write_all(data + lo, len, sizeof(header) + lo, errors[c]);
+    }, 1);
+
+    int close_result = close(fd);
+    for (int err : errors) {
+        if (err != 0) {
+            throw file_error(path, std::strerror(err));
+        }
+    }
+    if (close_result != 0) {
+        throw file_error(path, std::strerror(errno));
+    }
+}
+
+void write_limb_file(const std::string& path, const std::vector<long long>& limbs, bool negative, uint64_t base) {
+    write_limb_file(path, limbs.data(), limbs.size(), negative, base);
+}
@@ -0,0 +1,39 @@
+#ifndef LIMB_FORMAT_H
+#define LIMB_FORMAT_H
+
+// The header of a binary limb record, shared by limb files and the
+// multiplication server's wire protocol (multiply_protocol.h). A record is
+// this header followed by count little-endian limbs.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "limb records are read in place and assume a little-endian host"
+#endif
+
+static constexpr char LIMB_FILE_MAGIC[8] = {'B', 'I', 'G', 'L', 'I', 'M', 'B', 'S'};
+static constexpr uint32_t LIMB_FILE_VERSION = 1;
+
+// 64 bytes, so the limbs after it stay 8-byte aligned in the mapping.
+struct limb_file_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t limb_bytes;
+    uint64_t base;
+    uint64_t count;
+    uint64_t checksum;
+    uint8_t negative;
+    uint8_t reserved[23];
+};
+static_assert(sizeof(limb_file_header) == 64, "limb file header must be 64 bytes");
+
+// Header for n limbs, including their checksum.
+limb_file_header make_limb_header(const long long* limbs, size_t n, bool negative, uint64_t base);
+
+// Why header cannot describe a record whose limbs fit in available bytes,
+// or empty if it can.
+std::string limb_header_error(const limb_file_header& header, size_t available);
+
+#endif // LIMB_FORMAT_H
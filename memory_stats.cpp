@@ -0,0 +1,110 @@
+#include "bigint_multiply.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "parlaylib/include/parlay/alloc.h"
+
+// Global operator new/delete replacements that count every heap allocation in
+// the process: the digit vectors of all kernels as well as the blocks parlay
+// and libstdc++ request. Each block carries a header holding its size (and
+// the start of the underlying malloc block) so that frees can be counted too.
+
+static constexpr size_t HEADER_SIZE = 16;
+
+static std::atomic<size_t> live_bytes{0};
+static std::atomic<size_t> peak_bytes{0};
+static std::atomic<size_t> total_bytes{0};
+static std::atomic<size_t> allocation_count{0};
+
+static size_t baseline_bytes = 0;
+static size_t parlay_baseline_bytes = 0;
+
+static void record_alloc(size_t size) {
+    size_t live = live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+    size_t peak = peak_bytes.load(std::memory_order_relaxed);
+    while (live > peak && !peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+    total_bytes.fetch_add(size, std::memory_order_relaxed);
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void* counted_alloc(size_t size, size_t align) {
+    size_t header = std::max(HEADER_SIZE, align);
+    void* base = align <= HEADER_SIZE
+        ? std::malloc(header + size)
+        : std::aligned_alloc(align, (header + size + align - 1) / align * align);
+    if (base == nullptr) {
+        return nullptr;
+    }
+
+    char* p = static_cast<char*>(base) + header;
+    reinterpret_cast<size_t*>(p)[-1] = size;
+    reinterpret_cast<void**>(p)[-2] = base;
+    record_alloc(size);
+    return p;
+}
+
+static void counted_free(void* p) {
+    if (p == nullptr) {
+        return;
+    }
+    live_bytes.fetch_sub(reinterpret_cast<size_t*>(p)[-1], std::memory_order_relaxed);
+    std::free(reinterpret_cast<void**>(p)[-2]);
+}
+
+static void* counted_alloc_or_throw(size_t size, size_t align) {
+    void* p = counted_alloc(size, align);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new(size_t size) { return counted_alloc_or_throw(size, HEADER_SIZE); }
+void* operator new[](size_t size) { return counted_alloc_or_throw(size, HEADER_SIZE); }
+void* operator new(size_t size, std::align_val_t align) { return counted_alloc_or_throw(size, size_t(align)); }
+void* operator new[](size_t size, std::align_val_t align) { return counted_alloc_or_throw(size, size_t(align)); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size, HEADER_SIZE); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size, HEADER_SIZE); }
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return counted_alloc(size, size_t(align));
+}
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return counted_alloc(size, size_t(align));
+}
+
+void operator delete(void* p) noexcept { counted_free(p); }
+void operator delete[](void* p) noexcept { counted_free(p); }
+void operator delete(void* p, size_t) noexcept { counted_free(p); }
+void operator delete[](void* p, size_t) noexcept { counted_free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { counted_free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { counted_free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { counted_free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { counted_free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { counted_free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { counted_free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { counted_free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { counted_free(p); }
+
+// Starts a new measurement window. Memory that is already live counts
+// neither towards the peak nor towards the totals.
+void allocation_stats_reset() {
+    size_t live = live_bytes.load(std::memory_order_relaxed);
+    baseline_bytes = live;
+    peak_bytes.store(live, std::memory_order_relaxed);
+    total_bytes.store(0, std::memory_order_relaxed);
+    allocation_count.store(0, std::memory_order_relaxed);
+    parlay_baseline_bytes = parlay::internal::memory_usage().first;
+}
+
+allocation_stats allocation_stats_read() {
+    allocation_stats s;
+    size_t peak = peak_bytes.load(std::memory_order_relaxed);
+    s.peak_bytes = peak > baseline_bytes ? peak - baseline_bytes : 0;
+    s.total_bytes = total_bytes.load(std::memory_order_relaxed);
+    s.allocations = allocation_count.load(std::memory_order_relaxed);
+    s.parlay_pool_bytes = static_cast<long long>(parlay::internal::memory_usage().first) -
+                          static_cast<long long>(parlay_baseline_bytes);
+    return s;
+}
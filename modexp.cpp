@@ -0,0 +1,215 @@
+#include "bigint_multiply.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+
+#include "parlaylib/include/parlay/parallel.h"
+
+using BigInt = std::vector<long long>;
+
+// v mod 10^n
+static BigInt low_digits(const BigInt &v, size_t n) {
+    BigInt res(v.begin(), v.begin() + std::min(n, v.size()));
+    normalize_vector(res);
+    return res;
+}
+
+// x * y mod 10^n from the low-half short product.
+static BigInt mullo_digits(const BigInt &x, const BigInt &y, size_t n) {
+    BigInt xs(x.begin(), x.begin() + std::min(n, x.size()));
+    BigInt ys(y.begin(), y.begin() + std::min(n, y.size()));
+    xs.resize(n, 0);
+    ys.resize(n, 0);
+    BigInt lo = karatsuba_mullo_vector(xs, ys);
+    normalize_vector(lo);
+    return low_digits(lo, n);
+}
+
+// floor(x * y / 10^shift), possibly one too small, from the high-half short
+// product. Both operands are padded with low zeros so the half that is formed
+// reaches a few guard digits below shift, which absorbs the carry from the
+// coefficients that are skipped. Requires shift >= max(|x|, |y|) - 1.
+static BigInt mulhi_digits(const BigInt &x, const BigInt &y, size_t shift) {
+    size_t len = std::max(x.size(), y.size());
+    size_t guard = std::to_string(81 * len).size() + 1;
+
+    BigInt xs(guard, 0), ys(guard, 0);
+    xs.insert(xs.end(), x.begin(), x.end());
+    ys.insert(ys.end(), y.begin(), y.end());
+    xs.resize(len + guard, 0);
+    ys.resize(len + guard, 0);
+
+    // The high half starts at coefficient len + guard - 1 of the padded
+    // product, which is coefficient len - 1 - guard of x * y.
+    BigInt hi = karatsuba_mulhi_vector(xs, ys);
+    normalize_vector(hi);
+    return shift_down_vector(hi, shift - (len - 1 - guard));
+}
+
+static bool is_zero(const BigInt &v) {
+    return v.size() == 1 && v[0] == 0;
+}
+
+// Exponent bits, least significant first. Peels 30 bits at a time off the
+// decimal digits with a short division.
+static std::vector<bool> to_bits(BigInt e) {
+    static constexpr long long CHUNK = 1LL << 30;
+    std::vector<bool> bits;
+    while (!is_zero(e)) {
+        long long rem = 0;
+        for (size_t i = e.size(); i-- > 0;) {
+            long long cur = rem * 10 + e[i];
+            e[i] = cur / CHUNK;
+            rem = cur % CHUNK;
+        }
+        normalize_vector(e);
+        for (int b = 0; b < 30; ++b) {
+            bits.push_back((rem >> b) & 1);
+        }
+    }
+    while (!bits.empty() && !bits.back()) {
+        bits.pop_back();
+    }
+    return bits;
+}
+
+static size_t window_size(size_t bits) {
+    if (bits <= 64) return 3;
+    if (bits <= 512) return 4;
+    if (bits <= 2048) return 5;
+    return 6;
+}
+
+modexp_engine::modexp_engine(const BigInt &modulus) : m(modulus) {
+    normalize_vector(m);
+    if (is_zero(m)) {
+        throw std::invalid_argument("Modulus must be positive");
+    }
+    n = m.size();
+
+    // Montgomery needs m invertible modulo R = 10^n.
+    long long last = m[0];
+    montgomery = n > 1 && last % 2 != 0 && last % 5 != 0;
+
+    if (montgomery) {
+        // Hensel lifting: inv <- inv * (2 - m * inv) doubles the number of
+        // correct low digits of m^-1 mod 10^n per step.
+        static constexpr long long INV_MOD_10[10] = {0, 1, 0, 7, 0, 0, 0, 3, 0, 9};
+        BigInt inv = {INV_MOD_10[last]};
+        for (size_t k = 1; k < n;) {
+            k = std::min(2 * k, n);
+            BigInt t = mullo_digits(m, inv, k);
+            BigInt two_minus_t = sub_vector(add_vector(shift_vector({1}, k), {2}), t);
+            inv = mullo_digits(inv, two_minus_t, k);
+        }
+        m_prime = sub_vector(shift_vector({1}, n), inv);
+        r2 = divmod_vector(shift_vector({1}, 2 * n), m).second;
+    } else {
+        mu = reciprocal_vector(m, 2 * n);
+    }
+}
+
+// x mod m for x < m^2, using floor(10^2n / m) in place of a division. Only
+// the high half of the quotient estimate and the low n+1 digits of q * m are
+// needed, since the remainder is known to be below 10^(n+1).
+BigInt modexp_engine::barrett_reduce(const BigInt &x) const {
+    BigInt q = mulhi_digits(shift_down_vector(x, n - 1), mu, n + 1);
+    BigInt r_low = low_digits(x, n + 1);
+    BigInt qm_low = mullo_digits(q, m, n + 1);
+    BigInt r = compare_vector(r_low, qm_low) >= 0
+        ? sub_vector(r_low, qm_low)
+        : sub_vector(add_vector(r_low, shift_vector({1}, n + 1)), qm_low);
+    while (compare_vector(r, m) >= 0) {
+        r = sub_vector(r, m);
+    }
+    return r;
+}
+
+// x / 10^n mod m for x < m * 10^n.
+BigInt modexp_engine::redc(const BigInt &x) const {
+    BigInt u = mullo_digits(x, m_prime, n);
+    BigInt t = shift_down_vector(add_vector(x, mul_vector(u, m)), n);
+    if (compare_vector(t, m) >= 0) {
+        t = sub_vector(t, m);
+    }
+    return t;
+}
+
+BigInt modexp_engine::mul_mod(const BigInt &a, const BigInt &b) const {
+    BigInt p = mul_vector(a, b);
+    return montgomery ? redc(p) : barrett_reduce(p);
+}
+
+BigInt modexp_engine::pow(const BigInt &base, const BigInt &exponent) const {
+    if (n == 1 && m[0] == 1) {
+        return {0};
+    }
+
+    BigInt b = base;
+    normalize_vector(b);
+    if (compare_vector(b, m) >= 0) {
+        b = divmod_vector(b, m).second;
+    }
+    if (montgomery) {
+        b = redc(mul_vector(b, r2));
+    }
+
+    BigInt e = exponent;
+    normalize_vector(e);
+    std::vector<bool> bits = to_bits(e);
+
+    BigInt one = montgomery ? divmod_vector(shift_vector({1}, n), m).second : BigInt{1};
+    if (bits.empty()) {
+        return montgomery ? redc(one) : one;
+    }
+
+    // Odd powers b, b^3, ..., b^(2^w - 1) for the sliding window.
+    size_t w = window_size(bits.size());
+    std::vector<BigInt> table(size_t{1} << (w - 1));
+    table[0] = b;
+    BigInt b2 = mul_mod(b, b);
+    for (size_t i = 1; i < table.size(); ++i) {
+        table[i] = mul_mod(table[i - 1], b2);
+    }
+
+    BigInt acc = one;
+    size_t i = bits.size();
+    while (i > 0) {
+        if (!bits[i - 1]) {
+            acc = mul_mod(acc, acc);
+            --i;
+            continue;
+        }
+
+        // Longest window bits[lo, i) of at most w bits that ends in a one.
+        size_t lo = i > w ? i - w : 0;
+        while (!bits[lo]) {
+            ++lo;
+        }
+        size_t value = 0;
+        for (size_t j = i; j-- > lo;) {
+            value = (value << 1) | bits[j];
+            acc = mul_mod(acc, acc);
+        }
+        acc = mul_mod(acc, table[value >> 1]);
+        i = lo;
+    }
+
+    return montgomery ? redc(acc) : acc;
+}
+
+// Each exponentiation runs on its own worker; at these operand sizes the
+// kernels stay sequential, so parallelism comes from the batch.
+std::vector<BigInt> modexp_engine::pow_batch(const std::vector<std::pair<BigInt, BigInt>> &jobs) const {
+    std::vector<BigInt> results(jobs.size());
+    parlay::parallel_for(0, jobs.size(), [&](size_t i) {
+        results[i] = pow(jobs[i].first, jobs[i].second);
+    }, 1);
+    return results;
+}
+
+std::string modexp_string(const std::string &base, const std::string &exponent, const std::string &modulus) {
+    modexp_engine engine(string_to_vector(modulus));
+    return vector_to_string(engine.pow(string_to_vector(base), string_to_vector(exponent)));
+}
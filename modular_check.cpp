@@ -0,0 +1,125 @@
+#include "bigint_multiply.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "parlaylib/include/parlay/parallel.h"
+#include "parlaylib/include/parlay/random.h"
+
+static constexpr size_t RESIDUE_BLOCK_SIZE = 4096;
+
+static uint64_t mulmod(uint64_t a, uint64_t b, uint64_t p) {
+    return static_cast<uint64_t>(static_cast<unsigned __int128>(a) * b % p);
+}
+
+static uint64_t powmod(uint64_t a, uint64_t e, uint64_t p) {
+    uint64_t r = 1 % p;
+    for (a %= p; e > 0; e >>= 1) {
+        if (e & 1) r = mulmod(r, a, p);
+        a = mulmod(a, a, p);
+    }
+    return r;
+}
+
+// Sum of digit(i) * 10^i mod p over i < n. Each block is reduced on its own
+// by Horner's rule and the block residues are then combined, again by Horner,
+// with 10^RESIDUE_BLOCK_SIZE as the base. digit(i) may be any signed value,
+// which lets raw, uncarried kernel output be reduced directly.
+template <typename F>
+static uint64_t residue(size_t n, uint64_t p, F&& digit) {
+    size_t blocks = (n + RESIDUE_BLOCK_SIZE - 1) / RESIDUE_BLOCK_SIZE;
+    std::vector<uint64_t> partial(blocks);
+
+    parlay::parallel_for(0, blocks, [&](size_t b) {
+        size_t start = b * RESIDUE_BLOCK_SIZE;
+        size_t end = std::min(start + RESIDUE_BLOCK_SIZE, n);
+        uint64_t r = 0;
+        for (size_t i = end; i-- > start;) {
+            long long d = digit(i) % static_cast<long long>(p);
+            r = (mulmod(r, 10, p) + static_cast<uint64_t>(d < 0 ? d + static_cast<long long>(p) : d)) % p;
+        }
+        partial[b] = r;
+    }, 1);
+
+    uint64_t base = powmod(10, RESIDUE_BLOCK_SIZE, p);
+    uint64_t r = 0;
+    for (size_t b = blocks; b-- > 0;) {
+        r = (mulmod(r, base, p) + partial[b]) % p;
+    }
+    return r;
+}
+
+uint64_t residue_vector(const std::vector<long long>& v, uint64_t p) {
+    return residue(v.size(), p, [&](size_t i) { return v[i]; });
+}
+
+uint64_t residue_string(const std::string& s, uint64_t p) {
+    size_t n = s.size();
+    return residue(n, p, [&](size_t i) { return static_cast<long long>(s[n - 1 - i] - '0'); });
+}
+
+// Deterministic Miller-Rabin for 64-bit n.
+static bool is_prime(uint64_t n) {
+    static constexpr uint64_t BASES[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+    if (n < 2) return false;
+    for (uint64_t q : BASES) {
+        if (n % q == 0) return n == q;
+    }
+
+    uint64_t d = n - 1;
+    int s = 0;
+    while (d % 2 == 0) {
+        d /= 2;
+        ++s;
+    }
+
+    for (uint64_t a : BASES) {
+        uint64_t x = powmod(a, d, n);
+        if (x == 1 || x == n - 1) continue;
+        bool composite = true;
+        for (int i = 1; i < s && composite; ++i) {
+            x = mulmod(x, x, n);
+            composite = x != n - 1;
+        }
+        if (composite) return false;
+    }
+    return true;
+}
+
+// count distinct primes drawn uniformly from [2^60, 2^61).
+std::vector<uint64_t> random_primes_61(size_t count, size_t seed) {
+    parlay::random_generator gen(seed);
+    std::vector<uint64_t> primes;
+    while (primes.size() < count) {
+        uint64_t candidate = (uint64_t{1} << 60) | (gen() & ((uint64_t{1} << 60) - 1)) | 1;
+        if (is_prime(candidate) && std::find(primes.begin(), primes.end(), candidate) == primes.end()) {
+            primes.push_back(candidate);
+        }
+    }
+    return primes;
+}
+
+// Checks a * b == c modulo `rounds` random 61-bit primes. A wrong c passes a
+// single round only if p divides a * b - c, which for an n-digit difference
+// happens for at most n / 18 of the ~2^55 candidate primes.
+bool modular_check(const std::string& a, const std::string& b, const decimal_view& c,
+                   size_t rounds, size_t seed) {
+    for (uint64_t p : random_primes_61(rounds, seed)) {
+        if (mulmod(residue_string(a, p), residue_string(b, p), p) != c.residue(p)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The same check on digit or coefficient vectors, for operands that never
+// exist as strings.
+bool modular_check(const std::vector<long long>& a, const std::vector<long long>& b,
+                   const std::vector<long long>& c, size_t rounds, size_t seed) {
+    for (uint64_t p : random_primes_61(rounds, seed)) {
+        if (mulmod(residue_vector(a, p), residue_vector(b, p), p) != residue_vector(c, p)) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,314 @@
+#include "bigint_multiply.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include "parlaylib/include/parlay/parallel.h"
+
+#include "bigint_numa.h"
+#include "bigint_profile.h"
+
+static constexpr size_t BASECASE_THRESHOLD = 64;
+static constexpr size_t PARALLEL_THRESHOLD = 10000;
+// Subproducts this short run sequentially; see SEQUENTIAL_THRESHOLD in
+// par_karatsuba.cpp.
+static constexpr size_t SEQUENTIAL_THRESHOLD = 1024;
+// Products at least this long are split among the NUMA nodes under local
+// placement. Below it, the remote traffic costs less than starting one
+// bound scheduler per node.
+static constexpr size_t NUMA_THRESHOLD = size_t(1) << 15;
+
+using BigInt = std::vector<long long>;
+
+// Scratch for an n-digit product. A level keeps x0 + x1, y0 + y1 and their
+// product (2n digits) below which the subproducts recurse. Sequential levels
+// run the three subproducts one after another in the same space. Parallel
+// levels give each one its own.
+static size_t scratch_size(size_t n, size_t parallel_depth) {
+    if (n <= BASECASE_THRESHOLD) {
+        return 0;
+    }
+    size_t below = scratch_size(n / 2, parallel_depth > 0 ? parallel_depth - 1 : 0);
+    return 2 * n + (parallel_depth > 0 ? 3 * below : below);
+}
+
+// Schoolbook product. out never overlaps x or y, and saying so lets the
+// compiler vectorize the inner loop.
+static void basecase_into(const long long* __restrict x, const long long* __restrict y, size_t n,
+                          long long* __restrict out) {
+    std::fill(out, out + 2 * n, 0);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            out[i + j] += x[i] * y[j];
+        }
+    }
+}
+
+// out[0, 2n) = x[0, n) * y[0, n) for a power-of-two n, unnormalized. The
+// low and high subproducts are written straight into out and the middle one
+// into scratch, so nothing is allocated.
+static void karatsuba_into(const long long* x, const long long* y, size_t n, long long* out, long long* scratch,
+                           size_t parallel_depth) {
+    if (n <= BASECASE_THRESHOLD) {
+        basecase_into(x, y, n, out);
+        return;
+    }
+
+    size_t k = n / 2;
+    long long* xs = scratch;
+    long long* ys = scratch + k;
+    long long* mid = scratch + n;
+    long long* below = scratch + 2 * n;
+    bool parallel = parallel_depth > 0 && n >= PARALLEL_THRESHOLD / 4;
+
+    auto evaluate = [&](size_t i) {
+        xs[i] = x[i] + x[i + k];
+        ys[i] = y[i] + y[i + k];
+    };
+    if (parallel) {
+        bigint_parallel_for(0, k, evaluate);
+    } else {
+        for (size_t i = 0; i < k; ++i) evaluate(i);
+    }
+
+    if (parallel_depth > 0) {
+        size_t sub = scratch_size(k, parallel_depth - 1);
+        bigint_par_do(
+            [&]() { karatsuba_into(x, y, k, out, below, parallel_depth - 1); },
+            [&]() {bigint_par_do(
+                [&]() { karatsuba_into(x + k, y + k, k, out + n, below + sub, parallel_depth - 1); },
+                [&]() { karatsuba_into(xs, ys, k, mid, below + 2 * sub, parallel_depth - 1); }
+            );}
+        );
+    } else {
+        karatsuba_into(x, y, k, out, below, 0);
+        karatsuba_into(x + k, y + k, k, out + n, below, 0);
+        karatsuba_into(xs, ys, k, mid, below, 0);
+    }
+
+    // mid holds (x0 + x1)(y0 + y1); what is left after removing the low and
+    // high products is the middle term, added in at offset k.
+    auto interpolate = [&](size_t i) {
+        mid[i] -= out[i] + out[n + i];
+    };
+    auto combine = [&](size_t i) {
+        out[k + i] += mid[i];
+    };
+    if (parallel) {
+        bigint_parallel_for(0, n, interpolate);
+        bigint_parallel_for(0, n, combine);
+    } else {
+        for (size_t i = 0; i < n; ++i) interpolate(i);
+        for (size_t i = 0; i < n; ++i) combine(i);
+    }
+}
+
+// Enough parallel levels for 4 subproducts per worker, as long as they stay
+// above SEQUENTIAL_THRESHOLD.
+static size_t parallel_depth_for(size_t length, size_t workers) {
+    size_t depth = 0;
+    size_t tasks = 1;
+    while (workers > 1 && tasks < 4 * workers && (length >> depth) > SEQUENTIAL_THRESHOLD) {
+        ++depth;
+        tasks *= 3;
+    }
+    return depth;
+}
+
+// The operand of subproduct r at split depth d. Written in base 3, r gives
+// the half taken at each level from the top: 0 low, 1 high, 2 their sum, in
+// the order karatsuba_into recurses. The operand is therefore a sum of
+// (n >> d)-digit pieces of x, one per offset collected here.
+static void gather_operand(const long long* x, size_t n, size_t r, size_t d, long long* out) {
+    std::vector<size_t> offsets = {0};
+    size_t place = 1;
+    for (size_t level = 1; level < d; ++level) place *= 3;
+    for (size_t level = 0; level < d; ++level, place /= 3) {
+        size_t half = n >> (level + 1);
+        size_t choice = (r / place) % 3;
+        size_t count = offsets.size();
+        for (size_t i = 0; i < count; ++i) {
+            if (choice == 1) {
+                offsets[i] += half;
+            } else if (choice == 2) {
+                offsets.push_back(offsets[i] + half);
+            }
+        }
+    }
+    bigint_parallel_for(0, n >> d, [&](size_t i) {
+        long long sum = 0;
+        for (size_t offset : offsets) sum += x[offset + i];
+        out[i] = sum;
+    });
+}
+
+// Rebuilds the 2n-digit product of the subproducts under index prefix from
+// the leaves, with the same interpolation as karatsuba_into. leaf(r) points
+// at the (2n >> depth)-limb product of subproduct r. scratch needs 2n limbs.
+template <class Leaf>
+static void assemble(size_t n, size_t depth, size_t prefix, const Leaf& leaf, long long* out, long long* scratch) {
+    if (depth == 0) {
+        const long long* product = leaf(prefix);
+        bigint_parallel_for(0, 2 * n, [&](size_t i) { out[i] = product[i]; });
+        return;
+    }
+    size_t k = n / 2;
+    long long* mid = scratch;
+    long long* below = scratch + n;
+    assemble(k, depth - 1, 3 * prefix, leaf, out, below);
+    assemble(k, depth - 1, 3 * prefix + 1, leaf, out + n, below);
+    assemble(k, depth - 1, 3 * prefix + 2, leaf, mid, below);
+    bigint_parallel_for(0, n, [&](size_t i) { mid[i] -= out[i] + out[n + i]; });
+    bigint_parallel_for(0, n, [&](size_t i) { out[k + i] += mid[i]; });
+}
+
+// Asking for num_workers starts the calling thread's scheduler now, so the
+// first product does not pay for spawning the workers.
+mul_context::mul_context(numa_placement placement)
+    : place(placement), num_workers(parlay::num_workers()), nodes(numa_nodes()) {}
+
+mul_context::~mul_context() = default;
+
+const mul_context::plan& mul_context::plan_for(size_t length) {
+    size_t log = 0;
+    while ((size_t(1) << log) < length) ++log;
+    if (plans.size() <= log) {
+        plans.resize(log + 1);
+    }
+    plan& p = plans[log];
+    if (p.scratch == 0) {
+        p.parallel_depth = parallel_depth_for(length, num_workers);
+        p.scratch = scratch_size(length, p.parallel_depth) + 1;
+    }
+    return p;
+}
+
+// out[0, 2n) = x * y for a power-of-two n, unnormalized, split among the
+// nodes. The recursion is unrolled to the depth d at which there are 4
+// subproducts per node. Node i takes a contiguous run of them: its threads
+// gather the operands from x and y into the node's arena and multiply them
+// there. x and y are then read across nodes once, and all the recursion
+// below runs in local memory. The caller's pool interpolates the 3^d
+// products back together in scratch.
+void mul_context::multiply_on_nodes(const long long* x, const long long* y, size_t n, long long* out,
+                                    long long* scratch) {
+    size_t d = 1;
+    size_t count = 3;
+    while (count < 4 * nodes && (n >> (d + 1)) > SEQUENTIAL_THRESHOLD) {
+        ++d;
+        count *= 3;
+    }
+    size_t m = n >> d;
+    if (!node_workers) {
+        node_arenas.resize(nodes);
+        node_workers = std::make_unique<node_pool>(num_workers);
+    }
+    // Subproduct r lives in node owner(r)'s arena as [x operand | y operand |
+    // 2m-limb product], 4m limbs in all, after those of lower r on that node.
+    auto first = [&](size_t node) { return node * count / nodes; };
+    auto owner = [&](size_t r) {
+        size_t node = r * nodes / count;
+        while (first(node + 1) <= r) ++node;
+        while (first(node) > r) --node;
+        return node;
+    };
+
+    node_workers->run([&](size_t node) {
+        size_t begin = first(node), end = first(node + 1);
+        size_t depth = parallel_depth_for(m, parlay::num_workers());
+        size_t needed = (end - begin) * 4 * m + scratch_size(m, depth) + 1;
+        numa_array& local = node_arenas[node];
+        if (local.size() < needed) {
+            local = numa_array(needed, numa_placement::local, node);
+        }
+        long long* node_scratch = local.data() + (end - begin) * 4 * m;
+        for (size_t r = begin; r < end; ++r) {
+            long long* xs = local.data() + (r - begin) * 4 * m;
+            long long* ys = xs + m;
+            gather_operand(x, n, r, d, xs);
+            gather_operand(y, n, r, d, ys);
+            karatsuba_into(xs, ys, m, ys + m, node_scratch, depth);
+        }
+    });
+
+    auto leaf = [&](size_t r) -> const long long* {
+        size_t node = owner(r);
+        return node_arenas[node].data() + (r - first(node)) * 4 * m + 2 * m;
+    };
+    assemble(n, d, 0, leaf, out, scratch);
+}
+
+size_t mul_context::arena_needed(size_t length) {
+    size_t n = 1;
+    while (n < length) n *= 2;
+    return 4 * n + plan_for(n).scratch;
+}
+
+BigInt mul_context::multiply(const BigInt& x, const BigInt& y) {
+    BigInt out;
+    multiply(x, y, out);
+    return out;
+}
+
+// As in mul_vector, a longer operand is cut into pieces the size of the
+// shorter one, here rounded up to a power of two. Both go through the arena:
+// [padded piece | padded short operand | piece product | scratch].
+void mul_context::multiply(const BigInt& x, const BigInt& y, BigInt& out) {
+    if (&out == &x || &out == &y) {
+        BigInt product;
+        multiply(x, y, product);
+        out = std::move(product);
+        return;
+    }
+    const BigInt& big = x.size() >= y.size() ? x : y;
+    const BigInt& small = x.size() >= y.size() ? y : x;
+    if (small.empty()) {
+        out.assign(1, 0);
+        return;
+    }
+
+    size_t n = 1;
+    while (n < small.size()) n *= 2;
+    const plan& p = plan_for(n);
+    size_t needed = arena_needed(n);
+    if (arena.size() < needed) {
+        arena = numa_array(needed, place);
+    }
+    long long* piece = arena.data();
+    long long* other = piece + n;
+    long long* product = other + n;
+    long long* scratch = product + 2 * n;
+
+    std::copy(small.begin(), small.end(), other);
+    std::fill(other + small.size(), other + n, 0);
+
+    out.assign(big.size() + n + 1, 0);
+    for (size_t start = 0; start < big.size(); start += n) {
+        size_t end = std::min(start + n, big.size());
+        std::copy(big.begin() + start, big.begin() + end, piece);
+        std::fill(piece + (end - start), piece + n, 0);
+
+        if (place == numa_placement::local && nodes > 1 && n >= NUMA_THRESHOLD) {
+            multiply_on_nodes(piece, other, n, product, scratch);
+        } else {
+            karatsuba_into(piece, other, n, product, scratch, p.parallel_depth);
+        }
+        size_t count = std::min(2 * n, out.size() - start);
+        for (size_t i = 0; i < count; ++i) {
+            out[start + i] += product[i];
+        }
+    }
+    normalize_vector(out);
+}
+
+// Digits are base 10, so there is no radix conversion table to keep; the
+// strings are parsed and printed directly.
+std::string mul_context::multiply(const std::string& a, const std::string& b) {
+    BigInt x = string_to_vector(a);
+    BigInt y = string_to_vector(b);
+    normalize_vector(x);
+    normalize_vector(y);
+    BigInt product;
+    multiply(x, y, product);
+    return vector_to_string(product);
+}
@@ -0,0 +1,113 @@
+#include "bigint_multiply.h"
+#include <vector>
+#include <string>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "multiply_protocol.h"
+
+using BigInt = std::vector<long long>;
+
+multiply_client::multiply_client(const std::string& socket_path) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error(socket_path + ": socket path too long");
+    }
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error(std::string("socket: ") + std::strerror(errno));
+    }
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        int error = errno;
+        close(fd);
+        fd = -1;
+        throw std::runtime_error(socket_path + ": " + std::strerror(error));
+    }
+}
+
+multiply_client::~multiply_client() {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+multiply_client::multiply_client(multiply_client&& other) noexcept : fd(other.fd), next_id(other.next_id) {
+    other.fd = -1;
+}
+
+multiply_client& multiply_client::operator=(multiply_client&& other) noexcept {
+    if (this != &other) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        fd = other.fd;
+        next_id = other.next_id;
+        other.fd = -1;
+    }
+    return *this;
+}
+
+// Sends one request and waits for its reply. A product is stored in
+// *product; stats and error replies are returned or thrown as text.
+std::string multiply_client::request(uint32_t type, const BigInt* x, const BigInt* y, BigInt* product) {
+    if (fd < 0) {
+        throw std::runtime_error("multiply_client: not connected");
+    }
+    uint64_t id = next_id++;
+    size_t length = x ? limb_record_bytes(x->size()) + limb_record_bytes(y->size()) : 0;
+    frame_header header = {FRAME_MAGIC, type, id, length};
+    send_all(fd, &header, sizeof(header));
+    if (x) {
+        send_limb_record(fd, *x, false);
+        send_limb_record(fd, *y, false);
+    }
+
+    frame_header reply;
+    if (!recv_all(fd, &reply, sizeof(reply))) {
+        throw std::runtime_error("multiply_client: server closed the connection");
+    }
+    if (reply.magic != FRAME_MAGIC || reply.id != id) {
+        throw std::runtime_error("multiply_client: malformed reply");
+    }
+
+    if (reply.type == static_cast<uint32_t>(frame_type::product) && product) {
+        size_t available = reply.length;
+        bool negative = false;
+        *product = recv_limb_record(fd, available, negative);
+        discard(fd, available);
+        return "";
+    }
+    std::string text(reply.length, '\0');
+    if (!recv_all(fd, &text[0], text.size()) && !text.empty()) {
+        throw std::runtime_error("multiply_client: server closed the connection");
+    }
+    if (reply.type == static_cast<uint32_t>(frame_type::error)) {
+        throw std::runtime_error(text);
+    }
+    if (reply.type != static_cast<uint32_t>(frame_type::stats_reply) || product) {
+        throw std::runtime_error("multiply_client: unexpected reply type " + std::to_string(reply.type));
+    }
+    return text;
+}
+
+BigInt multiply_client::multiply(const BigInt& x, const BigInt& y) {
+    BigInt product;
+    request(static_cast<uint32_t>(frame_type::multiply), &x, &y, &product);
+    return product;
+}
+
+std::string multiply_client::multiply(const std::string& a, const std::string& b) {
+    return vector_to_string(multiply(string_to_vector(a), string_to_vector(b)));
+}
+
+std::string multiply_client::stats() {
+    return request(static_cast<uint32_t>(frame_type::stats), nullptr, nullptr, nullptr);
+}
@@ -0,0 +1,440 @@
+// Batch driver: streams multiplication jobs from a JSONL file and writes one
+// JSON result line per job.
+//
+//   ./multiply_jobs [--results FILE] [--queue N] jobs.jsonl
+//
+// Each line is a flat JSON object:
+//   {"id": "j1", "a": "123", "b": "456"}
+//   {"id": "j2", "a_file": "x.txt", "b_file": "y.limbs", "algorithm": "par_toom_cook_plib",
+//    "expected_hash": "9f0c...", "output": "product.txt"}
+// "algorithm" is a name or a multiply_test number; the default "auto" uses
+// mul_vector. "expected_hash" is the product's hash as reported in the
+// results. "output" writes the product to a file, as binary limbs if the
+// path ends in .limbs.
+//
+// Parsing, multiplying and writing run as a three-stage pipeline. A reader
+// thread loads operands and the main thread multiplies. A writer thread
+// carries, hashes and writes results. The stages pass jobs through bounded
+// queues, so they overlap across jobs and at most a few operands are held in
+// memory at once.
+
+#include "bigint_multiply.h"
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "parlaylib/include/parlay/parallel.h"
+
+#include "bounded_queue.h"
+
+using clock_type = std::chrono::steady_clock;
+
+// ------------------------- Job lines -----------------------------------
+
+// A flat JSON object with string, number, boolean or null values, which is
+// all a job line holds. Values are kept as their text.
+static std::map<std::string, std::string> parse_json_object(const std::string& line) {
+    size_t i = 0;
+    auto skip_space = [&] {
+        while (i < line.size() && std::isspace(static_cast<unsigned char>(line[i]))) ++i;
+    };
+    auto expect = [&](char c) {
+        skip_space();
+        if (i >= line.size() || line[i] != c) {
+            throw std::invalid_argument(std::string("expected '") + c + "' at column " + std::to_string(i + 1));
+        }
+        ++i;
+    };
+    auto parse_string = [&] {
+        expect('"');
+        std::string s;
+        while (i < line.size() && line[i] != '"') {
+            char c = line[i++];
+            if (c != '\\') {
+                s += c;
+                continue;
+            }
+            if (i >= line.size()) break;
+            char e = line[i++];
+            switch (e) {
+                case 'n': s += '\n'; break;
+                case 't': s += '\t'; break;
+                case 'r': s += '\r'; break;
+                case 'b': s += '\b'; break;
+                case 'f': s += '\f'; break;
+                case 'u': {
+                    if (i + 4 > line.size()) throw std::invalid_argument("truncated \\u escape");
+                    unsigned cp = std::stoul(line.substr(i, 4), nullptr, 16);
+                    i += 4;
+                    if (cp < 0x80) {
+                        s += char(cp);
+                    } else if (cp < 0x800) {
+                        s += char(0xc0 | (cp >> 6));
+                        s += char(0x80 | (cp & 0x3f));
+                    } else {
+                        s += char(0xe0 | (cp >> 12));
+                        s += char(0x80 | ((cp >> 6) & 0x3f));
+                        s += char(0x80 | (cp & 0x3f));
+                    }
+                    break;
+                }
+                default: s += e;
+            }
+        }
+        expect('"');
+        return s;
+    };
+
+    std::map<std::string, std::string> fields;
+    expect('{');
+    skip_space();
+    if (i < line.size() && line[i] == '}') {
+        ++i;
+        return fields;
+    }
+    while (true) {
+        std::string key = parse_string();
+        expect(':');
+        skip_space();
+        if (i < line.size() && line[i] == '"') {
+            fields[key] = parse_string();
+        } else {
+            size_t start = i;
+            while (i < line.size() && line[i] != ',' && line[i] != '}' &&
+                   !std::isspace(static_cast<unsigned char>(line[i]))) {
+                if (line[i] == '{' || line[i] == '[') {
+                    throw std::invalid_argument("nested values are not supported (key \"" + key + "\")");
+                }
+                ++i;
+            }
+            if (start == i) throw std::invalid_argument("missing value for \"" + key + "\"");
+            fields[key] = line.substr(start, i - start);
+        }
+        skip_space();
+        if (i < line.size() && line[i] == ',') {
+            ++i;
+            continue;
+        }
+        expect('}');
+        return fields;
+    }
+}
+
+static std::string json_escape(const std::string& s) {
+    std::string res;
+    for (char c : s) {
+        switch (c) {
+            case '"': res += "\\\""; break;
+            case '\\': res += "\\\\"; break;
+            case '\n': res += "\\n"; break;
+            case '\t': res += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    res += buf;
+                } else {
+                    res += c;
+                }
+        }
+    }
+    return res;
+}
+
+enum class Kernel { AUTO, NAIVE, KARATSUBA, PAR_KARATSUBA, TOOM_COOK, PAR_TOOM_COOK, KARATSUBA_PLIB, TOOM_COOK_PLIB };
+
+// Names as in bench_bigint, numbers as in multiply_test.
+static Kernel parse_kernel(const std::string& name) {
+    static const std::map<std::string, Kernel> NAMES = {
+        {"auto", Kernel::AUTO},
+        {"naive", Kernel::NAIVE}, {"0", Kernel::NAIVE},
+        {"karatsuba", Kernel::KARATSUBA}, {"1", Kernel::KARATSUBA},
+        {"par_karatsuba", Kernel::PAR_KARATSUBA}, {"2", Kernel::PAR_KARATSUBA},
+        {"toom_cook", Kernel::TOOM_COOK}, {"3", Kernel::TOOM_COOK},
+        {"par_toom_cook", Kernel::PAR_TOOM_COOK}, {"4", Kernel::PAR_TOOM_COOK},
+        {"par_karatsuba_plib", Kernel::KARATSUBA_PLIB}, {"5", Kernel::KARATSUBA_PLIB},
+        {"par_toom_cook_plib", Kernel::TOOM_COOK_PLIB}, {"6", Kernel::TOOM_COOK_PLIB},
+    };
+    auto it = NAMES.find(name);
+    if (it == NAMES.end()) {
+        throw std::invalid_argument("unknown algorithm \"" + name + "\"");
+    }
+    return it->second;
+}
+
+// The explicit kernels take equal lengths, and the Karatsuba ones powers of
+// two; "auto" goes through mul_vector, which handles any shape.
+static std::vector<long long> multiply(Kernel kernel, std::vector<long long>& x, std::vector<long long>& y) {
+    if (kernel == Kernel::AUTO) {
+        return mul_vector(x, y);
+    }
+    size_t len = std::max(x.size(), y.size());
+    if (kernel == Kernel::KARATSUBA || kernel == Kernel::PAR_KARATSUBA || kernel == Kernel::KARATSUBA_PLIB) {
+        size_t p = 1;
+        while (p < len) p <<= 1;
+        len = p;
+    }
+    x.resize(len, 0);
+    y.resize(len, 0);
+    switch (kernel) {
+        case Kernel::NAIVE: return naive_mul_vector(x, y);
+        case Kernel::KARATSUBA: return karatsuba_mul_vector(x, y);
+        case Kernel::PAR_KARATSUBA: return par_karatsuba_mul_vector(x, y);
+        case Kernel::TOOM_COOK: return toom_cook_mul_vector(x, y);
+        case Kernel::PAR_TOOM_COOK: return par_toom_cook_mul_vector(x, y);
+        case Kernel::KARATSUBA_PLIB: return par_karatsuba_mul_vector_plib(x, y);
+        case Kernel::TOOM_COOK_PLIB: return par_toom_cook_mul_vector_plib(x, y);
+        default: return mul_vector(x, y);
+    }
+}
+
+// FNV-1a over the product's decimal text, most significant digit first,
+// as 16 hex digits.
+static std::string decimal_hash(const std::vector<long long>& digits) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = digits.size(); i-- > 0;) {
+        h ^= static_cast<uint64_t>('0' + digits[i]);
+        h *= 0x100000001b3ULL;
+    }
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(h));
+    return buf;
+}
+
+static bool ends_with(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static std::vector<long long> load_operand(const std::map<std::string, std::string>& fields, const std::string& name) {
+    auto inline_value = fields.find(name);
+    auto file = fields.find(name + "_file");
+    if (inline_value != fields.end() && file != fields.end()) {
+        throw std::invalid_argument("both \"" + name + "\" and \"" + name + "_file\" given");
+    }
+    std::vector<long long> v;
+    if (inline_value != fields.end()) {
+        const std::string& s = inline_value->second;
+        if (s.empty() || s.find_first_not_of("0123456789") != std::string::npos) {
+            throw std::invalid_argument("\"" + name + "\" is not a non-negative decimal integer");
+        }
+        // Sequential: an OpenMP region on this thread would start a team
+        // of its own next to the kernels'.
+        v.resize(s.size());
+        for (size_t i = 0; i < s.size(); ++i) {
+            v[s.size() - 1 - i] = s[i] - '0';
+        }
+    } else if (file != fields.end()) {
+        if (limb_file::matches(file->second)) {
+            limb_file f(file->second);
+            if (f.base() != 10 || f.negative() || !f.verify()) {
+                throw std::invalid_argument(file->second + ": not a valid non-negative base-10 limb file");
+            }
+            v = f.to_vector();
+        } else {
+            v = decimal_file(file->second).digits();
+        }
+    } else {
+        throw std::invalid_argument("missing \"" + name + "\" or \"" + name + "_file\"");
+    }
+    normalize_vector(v);
+    return v;
+}
+
+// ------------------------- Pipeline ------------------------------------
+
+struct job {
+    size_t line = 0;
+    std::string id;
+    std::string error;
+    Kernel kernel = Kernel::AUTO;
+    std::string expected_hash;
+    std::string output;
+    std::vector<long long> x, y, product;
+    size_t input_digits = 0;
+    clock_type::time_point start;
+    double parse_seconds = 0;
+    double multiply_seconds = 0;
+};
+
+static double seconds_since(clock_type::time_point start) {
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    std::string jobs_path;
+    std::string results_path;
+    size_t queue_capacity = 4;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            std::cout << "Usage: " << argv[0] << " [--results FILE] [--queue N] jobs.jsonl\n\n"
+                      << "  --results FILE - Write the result lines to FILE instead of stdout\n"
+                      << "  --queue N      - Jobs buffered between pipeline stages (default: 4)\n";
+            return 0;
+        } else if ((arg == "--results" || arg == "--queue") && i + 1 < argc) {
+            std::string value = argv[++i];
+            if (arg == "--results") {
+                results_path = value;
+            } else {
+                queue_capacity = std::max<size_t>(1, std::stoul(value));
+            }
+        } else if (jobs_path.empty()) {
+            jobs_path = arg;
+        } else {
+            std::cerr << "Error: unexpected argument " << arg << ".\n";
+            return 1;
+        }
+    }
+    if (jobs_path.empty()) {
+        std::cerr << "Error: no jobs file given (see --help).\n";
+        return 1;
+    }
+
+    std::ifstream jobs_file(jobs_path);
+    if (!jobs_file) {
+        std::cerr << "Error: could not open " << jobs_path << ".\n";
+        return 1;
+    }
+    std::ofstream results_file;
+    if (!results_path.empty()) {
+        results_file.open(results_path);
+        if (!results_file) {
+            std::cerr << "Error: could not open " << results_path << ".\n";
+            return 1;
+        }
+    }
+    std::ostream& results = results_path.empty() ? std::cout : results_file;
+
+    bounded_queue<job> parsed(queue_capacity);
+    bounded_queue<job> multiplied(queue_capacity);
+    auto run_start = clock_type::now();
+
+    // The I/O stages run under a one-worker scheduler of their own. Outside
+    // any scheduler, a parlay call from these threads would start a second
+    // full-size pool next to the one the kernels use.
+    std::thread reader([&] {
+        parlay::execute_with_scheduler(1, [&] {
+            std::string line;
+            size_t line_number = 0;
+            while (std::getline(jobs_file, line)) {
+                ++line_number;
+                if (line.find_first_not_of(" \t\r") == std::string::npos) {
+                    continue;
+                }
+                job j;
+                j.line = line_number;
+                j.id = std::to_string(line_number);
+                j.start = clock_type::now();
+                try {
+                    auto fields = parse_json_object(line);
+                    if (fields.count("id")) j.id = fields["id"];
+                    if (fields.count("algorithm")) j.kernel = parse_kernel(fields["algorithm"]);
+                    if (fields.count("expected_hash")) j.expected_hash = fields["expected_hash"];
+                    if (fields.count("output")) j.output = fields["output"];
+                    j.x = load_operand(fields, "a");
+                    j.y = load_operand(fields, "b");
+                    j.input_digits = j.x.size() + j.y.size();
+                } catch (const std::exception& e) {
+                    j.error = e.what();
+                }
+                j.parse_seconds = seconds_since(j.start);
+                parsed.push(std::move(j));
+            }
+            parsed.close();
+        });
+    });
+
+    std::vector<double> latencies;
+    size_t failures = 0;
+    size_t output_digits = 0;
+
+    std::thread writer([&] {
+        parlay::execute_with_scheduler(1, [&] {
+            while (auto item = multiplied.pop()) {
+                job& j = *item;
+                std::string hash;
+                bool ok = j.error.empty();
+                if (ok) {
+                    try {
+                        normalize_vector(j.product);
+                        hash = decimal_hash(j.product);
+                        if (!j.expected_hash.empty() && hash != j.expected_hash) {
+                            ok = false;
+                            j.error = "hash mismatch (expected " + j.expected_hash + ")";
+                        }
+                        if (!j.output.empty()) {
+                            if (ends_with(j.output, ".limbs")) {
+                                write_limb_file(j.output, j.product);
+                            } else {
+                                write_decimal_file(j.output, j.product);
+                            }
+                        }
+                    } catch (const std::exception& e) {
+                        ok = false;
+                        j.error = e.what();
+                    }
+                }
+
+                double latency = seconds_since(j.start);
+                latencies.push_back(latency);
+                failures += !ok;
+                output_digits += ok ? j.product.size() : 0;
+
+                results << "{\"id\":\"" << json_escape(j.id) << "\",\"ok\":" << (ok ? "true" : "false");
+                if (!hash.empty()) {
+                    results << ",\"digits\":" << j.product.size() << ",\"hash\":\"" << hash << "\"";
+                }
+                if (!j.error.empty()) {
+                    results << ",\"error\":\"" << json_escape(j.error) << "\"";
+                }
+                results << std::fixed << std::setprecision(3) << ",\"parse_ms\":" << 1e3 * j.parse_seconds
+                        << ",\"multiply_ms\":" << 1e3 * j.multiply_seconds << ",\"latency_ms\":" << 1e3 * latency
+                        << "}\n";
+                results.flush();
+            }
+        });
+    });
+
+    size_t input_digits = 0;
+    while (auto item = parsed.pop()) {
+        job& j = *item;
+        if (j.error.empty()) {
+            auto start = clock_type::now();
+            try {
+                j.product = multiply(j.kernel, j.x, j.y);
+            } catch (const std::exception& e) {
+                j.error = e.what();
+            }
+            j.multiply_seconds = seconds_since(start);
+            input_digits += j.input_digits;
+        }
+        j.x = {};
+        j.y = {};
+        multiplied.push(std::move(j));
+    }
+    multiplied.close();
+
+    reader.join();
+    writer.join();
+    double wall = seconds_since(run_start);
+
+    timing_summary latency = summarize_times(latencies);
+    double max_latency = latencies.empty() ? 0 : *std::max_element(latencies.begin(), latencies.end());
+    std::cerr << std::fixed << std::setprecision(3)
+              << "Jobs: " << latencies.size() << " (" << failures << " failed) in " << wall << " s\n"
+              << "Throughput: " << latencies.size() / wall << " jobs/s, "
+              << std::setprecision(0) << input_digits / wall << " input digits/s, "
+              << output_digits / wall << " output digits/s\n"
+              << std::setprecision(3) << "Latency (ms): median " << 1e3 * latency.median << ", p90 "
+              << 1e3 * latency.p90 << ", mean " << 1e3 * latency.mean << ", max " << 1e3 * max_latency << "\n";
+    return failures == 0 ? 0 : 1;
+}
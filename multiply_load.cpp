@@ -0,0 +1,152 @@
+// Load generator for multiply_server.
+//
+//   ./multiply_load [--clients N] [--requests N] [--min-digits N] [--max-digits N]
+//                   [--seed N] [--verify] SOCKET
+//
+// Each client thread opens its own connection and sends its requests one
+// after another, each as soon as the previous reply arrives. Operand sizes
+// are log-uniform between the two digit bounds. --verify checks every
+// product with modular_check. At the end the client-side throughput and
+// latency percentiles are printed, followed by the server's own statistics.
+
+#include "bigint_multiply.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "parlaylib/include/parlay/parallel.h"
+
+using clock_type = std::chrono::steady_clock;
+
+int main(int argc, char* argv[]) {
+    std::string socket_path;
+    size_t clients = 4;
+    size_t requests = 100;
+    size_t min_digits = 100;
+    size_t max_digits = 20000;
+    size_t seed = 1;
+    bool verify = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            std::cout << "Usage: " << argv[0]
+                      << " [--clients N] [--requests N] [--min-digits N] [--max-digits N] [--seed N] [--verify] SOCKET\n\n"
+                      << "  --clients N    - Concurrent connections (default: 4)\n"
+                      << "  --requests N   - Requests per connection (default: 100)\n"
+                      << "  --min-digits N - Smallest operand (default: 100)\n"
+                      << "  --max-digits N - Largest operand (default: 20000)\n"
+                      << "  --seed N       - Seed for the operand sizes and digits (default: 1)\n"
+                      << "  --verify       - Check every product with modular_check\n";
+            return 0;
+        } else if (arg == "--verify") {
+            verify = true;
+        } else if ((arg == "--clients" || arg == "--requests" || arg == "--min-digits" || arg == "--max-digits" ||
+                    arg == "--seed") && i + 1 < argc) {
+            size_t value = std::stoull(argv[++i]);
+            if (arg == "--clients") {
+                clients = std::max<size_t>(1, value);
+            } else if (arg == "--requests") {
+                requests = value;
+            } else if (arg == "--min-digits") {
+                min_digits = std::max<size_t>(1, value);
+            } else if (arg == "--max-digits") {
+                max_digits = value;
+            } else {
+                seed = value;
+            }
+        } else if (socket_path.empty()) {
+            socket_path = arg;
+        } else {
+            std::cerr << "Error: unexpected argument " << arg << ".\n";
+            return 1;
+        }
+    }
+    if (socket_path.empty()) {
+        std::cerr << "Error: no socket path given (see --help).\n";
+        return 1;
+    }
+    max_digits = std::max(max_digits, min_digits);
+
+    std::mutex mutex;
+    std::vector<double> latencies;
+    std::atomic<size_t> failures{0};
+    std::atomic<size_t> digits{0};
+    std::string first_error;
+
+    auto run_start = clock_type::now();
+    std::vector<std::thread> threads;
+    for (size_t c = 0; c < clients; ++c) {
+        threads.emplace_back([&, c] {
+            // Operands are generated on a one-worker scheduler so that the
+            // clients do not compete with the server for every core.
+            parlay::execute_with_scheduler(1, [&] {
+                std::vector<double> local;
+                try {
+                    multiply_client client(socket_path);
+                    std::mt19937_64 rng(seed * 1000003 + c);
+                    std::uniform_real_distribution<double> size(std::log(double(min_digits)),
+                                                                std::log(double(max_digits)));
+                    for (size_t r = 0; r < requests; ++r) {
+                        auto x = random_bigint_vector(size_t(std::exp(size(rng))), rng());
+                        auto y = random_bigint_vector(size_t(std::exp(size(rng))), rng());
+                        normalize_vector(x);
+                        normalize_vector(y);
+
+                        auto start = clock_type::now();
+                        auto product = client.multiply(x, y);
+                        local.push_back(std::chrono::duration<double>(clock_type::now() - start).count());
+                        digits += x.size() + y.size();
+
+                        if (verify && !modular_check(x, y, product)) {
+                            throw std::runtime_error("wrong product for request " + std::to_string(r));
+                        }
+                    }
+                } catch (const std::exception& e) {
+                    ++failures;
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (first_error.empty()) {
+                        first_error = e.what();
+                    }
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                latencies.insert(latencies.end(), local.begin(), local.end());
+            });
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    double wall = std::chrono::duration<double>(clock_type::now() - run_start).count();
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) {
+        return latencies.empty() ? 0.0 : 1e3 * latencies[std::min(latencies.size() - 1, size_t(p * latencies.size()))];
+    };
+    std::cout << std::fixed << std::setprecision(3)
+              << "Requests: " << latencies.size() << " from " << clients << " clients in " << wall << " s\n"
+              << "Throughput: " << latencies.size() / wall << " requests/s, " << std::setprecision(0)
+              << digits / wall << " input digits/s\n"
+              << std::setprecision(3) << "Latency (ms): p50 " << percentile(0.5) << ", p90 " << percentile(0.9)
+              << ", p99 " << percentile(0.99) << ", max " << (latencies.empty() ? 0.0 : 1e3 * latencies.back())
+              << "\n";
+    if (failures > 0) {
+        std::cerr << "Error: " << failures << " clients failed: " << first_error << "\n";
+    }
+
+    try {
+        multiply_client client(socket_path);
+        std::cout << "Server: " << client.stats() << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+#ifndef MULTIPLY_PROTOCOL_H
+#define MULTIPLY_PROTOCOL_H
+
+// Wire protocol between multiply_server and multiply_client, over a Unix
+// domain stream socket. Every message is a 24-byte frame header followed by
+// length bytes of payload:
+//
+//   multiply request  two limb records (limb_format.h), a then b
+//   stats request     empty
+//   product           one limb record
+//   stats reply       JSON text
+//   error             message text
+//
+// A limb record is the 64-byte limb file header followed by its limbs, so a
+// product can be saved as a limb file unchanged. Replies carry the id of the
+// request they answer and come back in request order on each connection.
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "bigint_multiply.h"
+#include "limb_format.h"
+
+static constexpr uint32_t FRAME_MAGIC = 0x4d474942;  // "BIGM"
+
+enum class frame_type : uint32_t {
+    multiply = 1,
+    stats = 2,
+    product = 3,
+    stats_reply = 4,
+    error = 5,
+};
+
+struct frame_header {
+    uint32_t magic;
+    uint32_t type;
+    uint64_t id;
+    uint64_t length;
+};
+static_assert(sizeof(frame_header) == 24, "frame header must be 24 bytes");
+
+// Writes all n bytes; throws on a closed or failed socket.
+inline void send_all(int fd, const void* data, size_t n) {
+    const char* p = static_cast<const char*>(data);
+    while (n > 0) {
+        ssize_t w = send(fd, p, n, MSG_NOSIGNAL);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("send: ") + std::strerror(errno));
+        }
+        p += w;
+        n -= w;
+    }
+}
+
+// Reads exactly n bytes. Returns false if the peer closed the connection
+// before the first byte; end of stream part way through is an error.
+inline bool recv_all(int fd, void* data, size_t n) {
+    char* p = static_cast<char*>(data);
+    size_t done = 0;
+    while (done < n) {
+        ssize_t r = recv(fd, p + done, n - done, 0);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("recv: ") + std::strerror(errno));
+        }
+        if (r == 0) {
+            if (done == 0) return false;
+            throw std::runtime_error("connection closed mid-message");
+        }
+        done += r;
+    }
+    return true;
+}
+
+// Skips n bytes, to stay in step after rejecting part of a payload.
+inline void discard(int fd, size_t n) {
+    char buffer[1 << 12];
+    while (n > 0) {
+        size_t chunk = std::min(n, sizeof(buffer));
+        if (!recv_all(fd, buffer, chunk)) {
+            throw std::runtime_error("connection closed mid-message");
+        }
+        n -= chunk;
+    }
+}
+
+inline void send_frame(int fd, frame_type type, uint64_t id, const void* payload, size_t n) {
+    frame_header header = {FRAME_MAGIC, static_cast<uint32_t>(type), id, n};
+    send_all(fd, &header, sizeof(header));
+    send_all(fd, payload, n);
+}
+
+inline size_t limb_record_bytes(size_t n) {
+    return sizeof(limb_file_header) + n * sizeof(long long);
+}
+
+inline void send_limb_record(int fd, const std::vector<long long>& limbs, bool negative) {
+    limb_file_header header = make_limb_header(limbs.data(), limbs.size(), negative, 10);
+    send_all(fd, &header, sizeof(header));
+    send_all(fd, limbs.data(), limbs.size() * sizeof(long long));
+}
+
+// Reads one limb record of at most available bytes and checks its header and
+// checksum. available is reduced by the record's size.
+inline std::vector<long long> recv_limb_record(int fd, size_t& available, bool& negative) {
+    limb_file_header header;
+    if (available < sizeof(header) || !recv_all(fd, &header, sizeof(header))) {
+        throw std::runtime_error("truncated limb record");
+    }
+    available -= sizeof(header);
+    std::string error = limb_header_error(header, available);
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+    std::vector<long long> limbs(header.count);
+    if (!recv_all(fd, limbs.data(), limbs.size() * sizeof(long long))) {
+        throw std::runtime_error("truncated limb record");
+    }
+    available -= limbs.size() * sizeof(long long);
+    if (header.base != 10) {
+        throw std::runtime_error("unsupported base " + std::to_string(header.base));
+    }
+    if (limb_checksum(limbs.data(), limbs.size()) != header.checksum) {
+        throw std::runtime_error("checksum mismatch");
+    }
+    negative = header.negative != 0;
+    return limbs;
+}
+
+// Limbs of a received operand may be uncarried. Negative limbs are refused,
+// and so are limbs above LLONG_MAX / 2, which keeps the carry from
+// overflowing. The operand is then carried into digits as on every other
+// input path.
+inline void carry_limb_operand(std::vector<long long>& limbs) {
+    for (size_t i = 0; i < limbs.size(); ++i) {
+        if (limbs[i] < 0 || limbs[i] > LLONG_MAX / 2) {
+            throw std::runtime_error("limb " + std::to_string(i) + " is out of range: " + std::to_string(limbs[i]));
+        }
+    }
+    normalize_vector(limbs);
+}
+
+#endif // MULTIPLY_PROTOCOL_H
@@ -0,0 +1,385 @@
+// Multiplication server: one process owns the worker pool and serves
+// products to any number of local clients over a Unix domain socket.
+//
+//   ./multiply_server [--max-bytes N] [--queue N] SOCKET
+//
+// The protocol is described in multiply_protocol.h; multiply_client is the
+// matching client and multiply_load a load generator.
+//
+// Each connection has a reader and a writer thread. The reader receives
+// requests and hands products to async_multiply, whose pool takes the
+// largest pending request whenever a worker frees. Small requests thus run
+// whole, many side by side, while a large one is split across every worker
+// that has nothing else to do. The writer waits for the results in request
+// order and sends them back. Requests that are accepted but not yet answered
+// count as the queue depth; the latency is the time from receiving a request
+// to sending its reply.
+
+#include "bigint_multiply.h"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "parlaylib/include/parlay/parallel.h"
+
+#include "bounded_queue.h"
+#include "multiply_protocol.h"
+
+using BigInt = std::vector<long long>;
+using clock_type = std::chrono::steady_clock;
+
+static constexpr size_t LATENCY_WINDOW = 4096;
+
+static volatile std::sig_atomic_t stop_requested = 0;
+
+static void request_stop(int) {
+    stop_requested = 1;
+}
+
+// Counters shared by all connections. Latency percentiles are taken over the
+// last LATENCY_WINDOW replies.
+class server_stats {
+public:
+    std::atomic<size_t> connections{0};
+    std::atomic<size_t> open_connections{0};
+    std::atomic<size_t> requests{0};
+    std::atomic<size_t> failed{0};
+    std::atomic<size_t> queue_depth{0};
+    std::atomic<size_t> max_queue_depth{0};
+    std::atomic<size_t> input_digits{0};
+    std::atomic<size_t> output_digits{0};
+
+    void enqueued() {
+        size_t depth = ++queue_depth;
+        size_t seen = max_queue_depth.load();
+        while (depth > seen && !max_queue_depth.compare_exchange_weak(seen, depth)) {
+        }
+    }
+
+    void answered(double latency_ms, bool ok) {
+        --queue_depth;
+        failed += !ok;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (latencies.size() < LATENCY_WINDOW) {
+            latencies.push_back(latency_ms);
+        } else {
+            latencies[next_latency] = latency_ms;
+        }
+        next_latency = (next_latency + 1) % LATENCY_WINDOW;
+        ++completed;
+    }
+
+    std::string json() const {
+        std::vector<double> window;
+        size_t answered_count;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            window = latencies;
+            answered_count = completed;
+        }
+        std::sort(window.begin(), window.end());
+        auto percentile = [&](double p) {
+            return window.empty() ? 0.0 : window[std::min(window.size() - 1, size_t(p * window.size()))];
+        };
+
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(3)
+            << "{\"uptime_s\":" << std::chrono::duration<double>(clock_type::now() - start).count()
+            << ",\"connections\":" << open_connections << ",\"connections_total\":" << connections
+            << ",\"requests\":" << requests << ",\"completed\":" << answered_count << ",\"failed\":" << failed
+            << ",\"queue_depth\":" << queue_depth << ",\"max_queue_depth\":" << max_queue_depth
+            << ",\"input_digits\":" << input_digits << ",\"output_digits\":" << output_digits
+            << ",\"latency_ms\":{\"samples\":" << window.size() << ",\"p50\":" << percentile(0.5)
+            << ",\"p90\":" << percentile(0.9) << ",\"p99\":" << percentile(0.99)
+            << ",\"max\":" << (window.empty() ? 0.0 : window.back()) << "}}";
+        return out.str();
+    }
+
+private:
+    clock_type::time_point start = clock_type::now();
+    mutable std::mutex mutex;
+    std::vector<double> latencies;
+    size_t next_latency = 0;
+    size_t completed = 0;
+};
+
+// A reply the writer still has to send: either a product to wait for or a
+// ready stats or error message.
+struct pending_reply {
+    uint64_t id = 0;
+    frame_type type = frame_type::error;
+    std::future<BigInt> product;
+    bool negative = false;
+    std::string text;
+    clock_type::time_point start;
+};
+
+class connection {
+public:
+    connection(int fd, size_t max_bytes, size_t queue_capacity, server_stats& stats)
+        : fd(fd), max_bytes(max_bytes), replies(queue_capacity), stats(stats) {
+        ++stats.connections;
+        ++stats.open_connections;
+        // Checksums are computed on these threads. A one-worker scheduler of
+        // their own keeps those parlay calls from starting a second pool.
+        reader = std::thread([this] { parlay::execute_with_scheduler(1, [this] { read_requests(); }); });
+        writer = std::thread([this] { parlay::execute_with_scheduler(1, [this] { write_replies(); }); });
+    }
+
+    // Replies to requests already received are still sent.
+    ~connection() {
+        shutdown(fd, SHUT_RD);
+        reader.join();
+        writer.join();
+        close(fd);
+        --stats.open_connections;
+    }
+
+    bool finished() const { return done; }
+
+    void stop_reading() { shutdown(fd, SHUT_RD); }
+
+private:
+    void reply_error(uint64_t id, const std::string& message) {
+        pending_reply reply;
+        reply.id = id;
+        reply.text = message;
+        reply.start = clock_type::now();
+        ++stats.requests;
+        stats.enqueued();
+        replies.push(std::move(reply));
+    }
+
+    void read_requests() {
+        try {
+            frame_header header;
+            while (recv_all(fd, &header, sizeof(header))) {
+                if (header.magic != FRAME_MAGIC) {
+                    break;
+                }
+                if (header.length > max_bytes) {
+                    reply_error(header.id, "request of " + std::to_string(header.length) +
+                                               " bytes exceeds the server limit of " + std::to_string(max_bytes));
+                    break;
+                }
+
+                if (header.type == static_cast<uint32_t>(frame_type::stats)) {
+                    discard(fd, header.length);
+                    pending_reply reply;
+                    reply.id = header.id;
+                    reply.type = frame_type::stats_reply;
+                    reply.start = clock_type::now();
+                    replies.push(std::move(reply));
+                    continue;
+                }
+                if (header.type != static_cast<uint32_t>(frame_type::multiply)) {
+                    discard(fd, header.length);
+                    reply_error(header.id, "unknown request type " + std::to_string(header.type));
+                    continue;
+                }
+
+                size_t available = header.length;
+                BigInt x, y;
+                bool x_negative = false, y_negative = false;
+                try {
+                    x = recv_limb_record(fd, available, x_negative);
+                    y = recv_limb_record(fd, available, y_negative);
+                    carry_limb_operand(x);
+                    carry_limb_operand(y);
+                } catch (const std::runtime_error& e) {
+                    discard(fd, available);
+                    reply_error(header.id, e.what());
+                    continue;
+                }
+                discard(fd, available);
+
+                pending_reply reply;
+                reply.id = header.id;
+                reply.type = frame_type::product;
+                reply.start = clock_type::now();
+                reply.negative = x_negative != y_negative;
+                stats.input_digits += x.size() + y.size();
+                ++stats.requests;
+                stats.enqueued();
+                reply.product = async_multiply(std::move(x), std::move(y));
+                replies.push(std::move(reply));
+            }
+        } catch (const std::exception&) {
+            // The connection failed part way through a message; whatever was
+            // accepted is still answered.
+        }
+        replies.close();
+    }
+
+    void write_replies() {
+        bool broken = false;
+        while (auto item = replies.pop()) {
+            pending_reply& reply = *item;
+            if (reply.type == frame_type::stats_reply) {
+                reply.text = stats.json();
+            }
+
+            BigInt product;
+            bool ok = reply.type != frame_type::error;
+            if (reply.type == frame_type::product) {
+                try {
+                    product = reply.product.get();
+                } catch (const std::exception& e) {
+                    ok = false;
+                    reply.type = frame_type::error;
+                    reply.text = e.what();
+                }
+            }
+
+            if (!broken) {
+                try {
+                    if (reply.type == frame_type::product) {
+                        bool zero = product.size() == 1 && product[0] == 0;
+                        frame_header header = {FRAME_MAGIC, static_cast<uint32_t>(frame_type::product), reply.id,
+                                               limb_record_bytes(product.size())};
+                        send_all(fd, &header, sizeof(header));
+                        send_limb_record(fd, product, reply.negative && !zero);
+                    } else {
+                        send_frame(fd, reply.type, reply.id, reply.text.data(), reply.text.size());
+                    }
+                } catch (const std::exception&) {
+                    broken = true;
+                    ok = false;
+                    shutdown(fd, SHUT_RD);
+                }
+            }
+
+            if (reply.type != frame_type::stats_reply) {
+                if (ok) {
+                    stats.output_digits += product.size();
+                }
+                stats.answered(std::chrono::duration<double, std::milli>(clock_type::now() - reply.start).count(), ok);
+            }
+        }
+        done = true;
+    }
+
+    int fd;
+    size_t max_bytes;
+    bounded_queue<pending_reply> replies;
+    server_stats& stats;
+    std::atomic<bool> done{false};
+    std::thread reader, writer;
+};
+
+static int listen_on(const std::string& path) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error(path + ": socket path too long");
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    // A socket left behind by a previous server is replaced; any other file
+    // is not touched.
+    struct stat sb;
+    if (lstat(path.c_str(), &sb) == 0) {
+        if (!S_ISSOCK(sb.st_mode)) {
+            throw std::runtime_error(path + ": exists and is not a socket");
+        }
+        unlink(path.c_str());
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error(std::string("socket: ") + std::strerror(errno));
+    }
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(fd, 64) != 0) {
+        int error = errno;
+        close(fd);
+        throw std::runtime_error(path + ": " + std::strerror(error));
+    }
+    return fd;
+}
+
+int main(int argc, char* argv[]) {
+    std::string socket_path;
+    size_t max_bytes = size_t(1) << 30;
+    size_t queue_capacity = 64;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            std::cout << "Usage: " << argv[0] << " [--max-bytes N] [--queue N] SOCKET\n\n"
+                      << "  --max-bytes N - Largest request accepted, in bytes (default: 1 GiB)\n"
+                      << "  --queue N     - Requests in flight per connection before reading pauses (default: 64)\n";
+            return 0;
+        } else if ((arg == "--max-bytes" || arg == "--queue") && i + 1 < argc) {
+            size_t value = std::stoull(argv[++i]);
+            if (arg == "--max-bytes") {
+                max_bytes = value;
+            } else {
+                queue_capacity = std::max<size_t>(1, value);
+            }
+        } else if (socket_path.empty()) {
+            socket_path = arg;
+        } else {
+            std::cerr << "Error: unexpected argument " << arg << ".\n";
+            return 1;
+        }
+    }
+    if (socket_path.empty()) {
+        std::cerr << "Error: no socket path given (see --help).\n";
+        return 1;
+    }
+
+    int listen_fd;
+    try {
+        listen_fd = listen_on(socket_path);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    struct sigaction action = {};
+    action.sa_handler = request_stop;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    server_stats stats;
+    std::list<connection> connections;
+    std::cerr << "Listening on " << socket_path << "\n";
+
+    while (!stop_requested) {
+        pollfd p = {listen_fd, POLLIN, 0};
+        int ready = poll(&p, 1, 200);
+        connections.remove_if([](const connection& c) { return c.finished(); });
+        if (ready <= 0) {
+            continue;
+        }
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd >= 0) {
+            connections.emplace_back(fd, max_bytes, queue_capacity, stats);
+        }
+    }
+
+    close(listen_fd);
+    unlink(socket_path.c_str());
+    for (auto& c : connections) {
+        c.stop_reading();
+    }
+    connections.clear();
+    std::cerr << stats.json() << "\n";
+    return 0;
+}
@@ -43,4 +43,45 @@ std::vector<long long> naive_mul_vector(const std::vector<long long>& x, const s
     }
     
     return res;
-}
\ No newline at end of file
+}
+// Low half of x * y: coefficients 0..n-1 for equal-length x and y.
+std::vector<long long> naive_mullo_vector(const std::vector<long long>& x, const std::vector<long long>& y) {
+    size_t n = x.size();
+    std::vector<long long> res(n, 0);
+
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j + i < n; ++j) {
+            res[i + j] += x[i] * y[j];
+        }
+    }
+
+    return res;
+}
+
+// High half of x * y: coefficients n-1..2n-2 for equal-length x and y.
+std::vector<long long> naive_mulhi_vector(const std::vector<long long>& x, const std::vector<long long>& y) {
+    size_t n = x.size();
+    std::vector<long long> res(n, 0);
+
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = n - 1 - i; j < n; ++j) {
+            res[i + j - (n - 1)] += x[i] * y[j];
+        }
+    }
+
+    return res;
+}
+
+// Middle product: coefficients n-1..2n-2 of x * y where |y| = n and |x| = 2n-1.
+std::vector<long long> naive_middle_product_vector(const std::vector<long long>& x, const std::vector<long long>& y) {
+    size_t n = y.size();
+    std::vector<long long> res(n, 0);
+
+    for (size_t t = 0; t < n; ++t) {
+        for (size_t j = 0; j < n; ++j) {
+            res[t] += x[n - 1 + t - j] * y[j];
+        }
+    }
+
+    return res;
+}
@@ -0,0 +1,249 @@
+#include "bigint_multiply.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <thread>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+
+#include "parlaylib/include/parlay/parallel.h"
+
+#include "bigint_numa.h"
+
+struct numa_node {
+    int id;
+    std::vector<int> cpus;  // the ones this process may run on
+};
+
+struct numa_topology {
+    std::vector<numa_node> nodes;  // nodes with at least one usable CPU
+    std::vector<int> memory;       // nodes with memory
+    size_t cpus = 0;
+};
+
+// Parses a sysfs list such as "0-3,8,10-11".
+static std::vector<int> parse_list(const std::string& text) {
+    std::vector<int> values;
+    std::stringstream in(text);
+    std::string range;
+    while (std::getline(in, range, ',')) {
+        if (range.empty()) continue;
+        size_t dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int v = first; v <= last; ++v) {
+            values.push_back(v);
+        }
+    }
+    return values;
+}
+
+static std::string read_line(const std::string& path) {
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+// Read once, from the thread that first asks. mul_context asks in its
+// constructor, before any thread is bound, so the affinity mask seen here is
+// the process's own.
+static const numa_topology& topology() {
+    static const numa_topology t = [] {
+        numa_topology t;
+#ifdef __linux__
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+            return t;
+        }
+        const std::string root = "/sys/devices/system/node/";
+        for (int id : parse_list(read_line(root + "online"))) {
+            numa_node node{id, {}};
+            for (int cpu : parse_list(read_line(root + "node" + std::to_string(id) + "/cpulist"))) {
+                if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)) {
+                    node.cpus.push_back(cpu);
+                }
+            }
+            if (!node.cpus.empty()) {
+                t.cpus += node.cpus.size();
+                t.nodes.push_back(std::move(node));
+            }
+        }
+        t.memory = parse_list(read_line(root + "has_memory"));
+#endif
+        return t;
+    }();
+    return t;
+}
+
+size_t numa_nodes() {
+    return std::max<size_t>(1, topology().nodes.size());
+}
+
+#ifdef __linux__
+// Best effort: where mbind is refused (no NUMA support, seccomp) the pages
+// are placed by first touch as before.
+static void set_policy(void* address, size_t bytes, int mode, const std::vector<int>& nodes) {
+    constexpr size_t BITS = 8 * sizeof(unsigned long);
+    int highest = *std::max_element(nodes.begin(), nodes.end());
+    std::vector<unsigned long> mask(highest / BITS + 1, 0);
+    for (int node : nodes) {
+        mask[node / BITS] |= 1UL << (node % BITS);
+    }
+    // The kernel reads maxnode - 1 bits.
+    syscall(SYS_mbind, address, bytes, mode, mask.data(), mask.size() * BITS + 1, 0);
+}
+#endif
+
+numa_array::numa_array(size_t n, numa_placement placement, size_t node) : count(n) {
+    if (n == 0) {
+        return;
+    }
+    void* p = mmap(nullptr, n * sizeof(long long), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    limbs = static_cast<long long*>(p);
+
+    const numa_topology& t = topology();
+    switch (placement) {
+    case numa_placement::naive:
+        // As a std::vector would: the calling thread zeroes, and so places,
+        // every page.
+        std::memset(limbs, 0, n * sizeof(long long));
+        break;
+    case numa_placement::interleave:
+#ifdef __linux__
+        if (t.memory.size() > 1) {
+            set_policy(limbs, n * sizeof(long long), MPOL_INTERLEAVE, t.memory);
+        }
+#endif
+        break;
+    case numa_placement::local: {
+#ifdef __linux__
+        if (t.nodes.size() > 1 && node < t.nodes.size()) {
+            set_policy(limbs, n * sizeof(long long), MPOL_PREFERRED, {t.nodes[node].id});
+        }
+#endif
+        // First touch by the workers of the calling thread's scheduler, which
+        // are the ones that go on to use the memory.
+        size_t page = std::max<size_t>(1, sysconf(_SC_PAGESIZE) / sizeof(long long));
+        parlay::parallel_for(0, (n + page - 1) / page, [&](size_t i) { limbs[i * page] = 0; });
+        break;
+    }
+    }
+}
+
+numa_array::~numa_array() {
+    if (limbs) {
+        munmap(limbs, count * sizeof(long long));
+    }
+}
+
+numa_array::numa_array(numa_array&& other) noexcept : limbs(other.limbs), count(other.count) {
+    other.limbs = nullptr;
+    other.count = 0;
+}
+
+numa_array& numa_array::operator=(numa_array&& other) noexcept {
+    if (this != &other) {
+        if (limbs) {
+            munmap(limbs, count * sizeof(long long));
+        }
+        limbs = other.limbs;
+        count = other.count;
+        other.limbs = nullptr;
+        other.count = 0;
+    }
+    return *this;
+}
+
+node_pool::node_pool(size_t workers) : errors(numa_nodes()) {
+    const numa_topology& t = topology();
+    for (size_t i = 0; i < errors.size(); ++i) {
+        threads.emplace_back([this, &t, workers, i] {
+            size_t share = workers;
+#ifdef __linux__
+            if (i < t.nodes.size()) {
+                cpu_set_t cpus;
+                CPU_ZERO(&cpus);
+                for (int cpu : t.nodes[i].cpus) {
+                    CPU_SET(cpu, &cpus);
+                }
+                sched_setaffinity(0, sizeof(cpus), &cpus);
+                share = std::max<size_t>(1, workers * t.nodes[i].cpus.size() / t.cpus);
+            }
+#endif
+            parlay::execute_with_scheduler(static_cast<unsigned int>(share), [this, i] { serve(i); });
+        });
+    }
+}
+
+node_pool::~node_pool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+// The loop of node's thread, inside its scheduler.
+void node_pool::serve(size_t node) {
+    size_t seen = 0;
+    for (;;) {
+        const std::function<void(size_t)>* f;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+            f = task;
+        }
+        std::exception_ptr error;
+        try {
+            (*f)(node);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        errors[node] = error;
+        if (--remaining == 0) {
+            finished.notify_all();
+        }
+    }
+}
+
+void node_pool::run(const std::function<void(size_t)>& f) {
+    std::unique_lock<std::mutex> lock(mutex);
+    task = &f;
+    remaining = threads.size();
+    ++generation;
+    wake.notify_all();
+    finished.wait(lock, [&] { return remaining == 0; });
+    task = nullptr;
+    for (auto& error : errors) {
+        if (error) {
+            std::exception_ptr first = error;
+            std::fill(errors.begin(), errors.end(), nullptr);
+            std::rethrow_exception(first);
+        }
+    }
+}
@@ -0,0 +1,189 @@
+#include "bigint_multiply.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "limb_format.h"
+
+using BigInt = std::vector<long long>;
+
+static constexpr size_t MIN_TILE_DIGITS = 64;
+// Tile buffers besides the context's arena, in tile lengths: the a and b
+// tiles, the 2T-limb sum of one anti-diagonal, its T-limb high half carried
+// into the next block, the T-limb output block and the tile product, which
+// mul_context::multiply sizes to 2T + 1 limbs.
+static constexpr size_t TILE_BUFFERS = 8;
+
+static std::runtime_error file_error(const std::string& path, const std::string& what) {
+    return std::runtime_error(path + ": " + what);
+}
+
+// Appends to a file descriptor with plain write(), so the product goes to
+// disk strictly in order.
+static void write_all(int fd, const std::string& path, const void* data, size_t n) {
+    const char* p = static_cast<const char*>(data);
+    while (n > 0) {
+        ssize_t w = write(fd, p, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            throw file_error(path, std::strerror(errno));
+        }
+        p += w;
+        n -= w;
+    }
+}
+
+// Copies tile t of f (T limbs, zero-padded past the end) out of the mapping.
+// The digits are checked here because the accumulation bounds assume 0-9.
+static void load_tile(const limb_file& f, const std::string& path, size_t t, size_t T, BigInt& tile) {
+    size_t start = t * T;
+    size_t end = std::min(start + T, f.size());
+    const long long* limbs = f.data();
+    for (size_t i = start; i < end; ++i) {
+        if (limbs[i] < 0 || limbs[i] > 9) {
+            throw file_error(path, "limb " + std::to_string(i) + " is not a decimal digit");
+        }
+    }
+    std::copy(limbs + start, limbs + end, tile.begin());
+    std::fill(tile.begin() + (end - start), tile.end(), 0);
+}
+
+// Schoolbook over tiles, in order of the output; each tile product itself is
+// a Karatsuba product through mul_context. Both operands are cut into
+// T-digit tiles, with T the largest power of two whose buffers and
+// mul_context arena fit in memory_budget bytes. Output block s (digits
+// [sT, (s+1)T)) receives the low halves of the tile products a_i * b_j with
+// i + j = s and the high halves of those with i + j = s - 1. The products of
+// one anti-diagonal are summed, the block is carried and appended to the
+// output, and the high half waits for the next block. The inputs stay in
+// their mappings; each tile is read as one contiguous run of its file, and
+// those pages are clean page cache the kernel can drop, so only the tile
+// buffers count against the budget. Each tile product runs in parallel
+// through the context.
+out_of_core_stats multiply_limb_files(const std::string& a_path, const std::string& b_path,
+                                      const std::string& output_path, size_t memory_budget) {
+    limb_file a(a_path);
+    limb_file b(b_path);
+    for (const auto* f : {&a, &b}) {
+        const std::string& path = f == &a ? a_path : b_path;
+        if (f->base() != 10) {
+            throw file_error(path, "only base-10 limb files can be multiplied");
+        }
+        if (!f->verify()) {
+            throw file_error(path, "checksum mismatch");
+        }
+    }
+
+    // Interleaved rather than local placement: local would add a per-node
+    // arena that arena_needed does not count against the budget.
+    mul_context context(numa_placement::interleave);
+    size_t longest = std::max<size_t>({a.size(), b.size(), 1});
+    size_t T = MIN_TILE_DIGITS;
+    auto working_bytes = [&](size_t t) { return (TILE_BUFFERS * t + 1 + context.arena_needed(t)) * sizeof(long long); };
+    if (working_bytes(T) > memory_budget) {
+        throw std::invalid_argument("memory budget of " + std::to_string(memory_budget) +
+                                    " bytes is below the smallest tile's " + std::to_string(working_bytes(T)));
+    }
+    while (T < longest && working_bytes(2 * T) <= memory_budget) {
+        T *= 2;
+    }
+
+    out_of_core_stats stats;
+    stats.tile_digits = T;
+    stats.working_bytes = working_bytes(T);
+    size_t a_tiles = std::max<size_t>(1, (a.size() + T - 1) / T);
+    size_t b_tiles = std::max<size_t>(1, (b.size() + T - 1) / T);
+
+    int fd = open(output_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw file_error(output_path, std::strerror(errno));
+    }
+    try {
+        // The header is written again at the end, once the count and
+        // checksum are known.
+        limb_file_header header = make_limb_header(nullptr, 0, a.negative() != b.negative(), 10);
+        write_all(fd, output_path, &header, sizeof(header));
+
+        BigInt x(T), y(T), product, diagonal(2 * T), high(T, 0), block(T);
+        long long carry = 0;
+        size_t written = 0;
+        size_t count = 0;               // limbs up to the last nonzero one
+        uint64_t checksum = 0;          // over all limbs written
+        uint64_t trailing_checksum = 0;  // over the zeros after limb count - 1
+
+        auto emit = [&](const long long* source, size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                long long v = source[i] + carry;
+                block[i] = v % 10;
+                carry = v / 10;
+            }
+            write_all(fd, output_path, block.data(), n * sizeof(long long));
+            uint64_t h = limb_checksum(block.data(), n, written);
+            checksum += h;
+            size_t last = n;
+            while (last > 0 && block[last - 1] == 0) --last;
+            if (last > 0) {
+                count = written + last;
+                trailing_checksum = limb_checksum(block.data() + last, n - last, count);
+            } else {
+                trailing_checksum += h;
+            }
+            written += n;
+            stats.bytes_written += n * sizeof(long long);
+        };
+
+        for (size_t s = 0; s + 1 < a_tiles + b_tiles; ++s) {
+            std::fill(diagonal.begin(), diagonal.end(), 0);
+            size_t first = s + 1 > b_tiles ? s + 1 - b_tiles : 0;
+            size_t last = std::min(s, a_tiles - 1);
+            for (size_t i = first; i <= last; ++i) {
+                load_tile(a, a_path, i, T, x);
+                load_tile(b, b_path, s - i, T, y);
+                stats.bytes_read += 2 * T * sizeof(long long);
+                context.multiply(x, y, product);
+                ++stats.tile_products;
+                for (size_t k = 0; k < product.size(); ++k) {
+                    diagonal[k] += product[k];
+                }
+            }
+            for (size_t k = 0; k < T; ++k) {
+                diagonal[k] += high[k];
+            }
+            emit(diagonal.data(), T);
+            std::copy(diagonal.begin() + T, diagonal.end(), high.begin());
+        }
+        emit(high.data(), T);
+        if (carry != 0) {
+            throw std::logic_error("multiply_limb_files: carry out of the last block");
+        }
+
+        // A zero product is the single digit 0, and never negative.
+        if (count == 0) {
+            long long zero = 0;
+            count = 1;
+            header.checksum = limb_checksum(&zero, 1);
+            header.negative = false;
+        } else {
+            header.checksum = checksum - trailing_checksum;
+        }
+        header.count = count;
+        if (pwrite(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+            ftruncate(fd, sizeof(header) + count * sizeof(long long)) != 0) {
+            throw file_error(output_path, std::strerror(errno));
+        }
+        stats.product_digits = count;
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+    if (close(fd) != 0) {
+        throw file_error(output_path, std::strerror(errno));
+    }
+    return stats;
+}
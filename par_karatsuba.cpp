@@ -10,24 +10,32 @@
 #include "parlaylib/include/parlay/sequence.h"
 #include "parlaylib/include/parlay/utilities.h"
 
+#include "bigint_profile.h"
+
 
 static constexpr size_t KARATSUBA_THRESHOLD = 64;
 static constexpr size_t PARALLEL_THRESHOLD = 10000;
+// Operands up to this length go to the sequential kernel and never reach the
+// OpenMP or parlay runtime. A 1024-digit product takes about 0.4 ms on one
+// core, while an OpenMP fork and join costs tens of microseconds.
+static constexpr size_t SEQUENTIAL_THRESHOLD = 1024;
 
 std::vector<long long> par_karatsuba_mul_vector_open(const std::vector<long long>& x, const std::vector<long long>& y) {
     auto len = x.size();    
-    std::vector<long long> res(2 * len);
-    
-    if (len <= KARATSUBA_THRESHOLD) {
-        return naive_mul_vector(x, y);
+    if (len <= SEQUENTIAL_THRESHOLD) {
+        return karatsuba_mul_vector(x, y);
     }
+    std::vector<long long> res(2 * len);
+    BIGINT_PROFILE_FRAME(len, 32 * len);
     
     auto k = len / 2;
     
+    BIGINT_PROFILE_BEGIN(split);
     std::vector<long long> Xr(x.begin(), x.begin() + k);
     std::vector<long long> Xl(x.begin() + k, x.end());
     std::vector<long long> Yr(y.begin(), y.begin() + k);
     std::vector<long long> Yl(y.begin() + k, y.end());
+    BIGINT_PROFILE_END(split, PROFILE_EVALUATE, 32 * len);
     
     std::vector<long long> P1, P2, P3;
     
@@ -37,18 +45,23 @@ std::vector<long long> par_karatsuba_mul_vector_open(const std::vector<long long
     #pragma omp parallel
     #pragma omp single nowait
     {
+        BIGINT_TRACE_SPAWN(p1);
         #pragma omp task shared(P1)
         {
-            P1 = par_karatsuba_mul_vector_open(Xl, Yl);
+            BIGINT_PROFILE_TASK(BIGINT_TRACE_TASK("karatsuba", p1, P1 = par_karatsuba_mul_vector_open(Xl, Yl)));
         }
 
+        BIGINT_TRACE_SPAWN(p2);
         #pragma omp task shared(P2)
         {
-            P2 = par_karatsuba_mul_vector_open(Xr, Yr);
+            BIGINT_PROFILE_TASK(BIGINT_TRACE_TASK("karatsuba", p2, P2 = par_karatsuba_mul_vector_open(Xr, Yr)));
         }
 
+        BIGINT_TRACE_SPAWN(sums);
         #pragma omp task shared(Xlr, Ylr)
         {
+            BIGINT_TRACE_SCOPE("evaluate", sums);
+            BIGINT_PROFILE_BEGIN(evaluate);
             if (k >= PARALLEL_THRESHOLD / 4) {
                 #pragma omp parallel for
                 for (size_t i = 0; i < k; ++i) {
@@ -61,18 +74,25 @@ std::vector<long long> par_karatsuba_mul_vector_open(const std::vector<long long
                     Ylr[i] = Yl[i] + Yr[i];
                 }
             }
+            BIGINT_PROFILE_END(evaluate, PROFILE_EVALUATE, 48 * k);
         }
 
+        BIGINT_PROFILE_JOIN_BEGIN(evaluated);
         #pragma omp taskwait
+        BIGINT_PROFILE_JOIN_END(evaluated);
 
+        BIGINT_TRACE_SPAWN(p3);
         #pragma omp task shared(P3, Xlr, Ylr)
         {
-            P3 = par_karatsuba_mul_vector_open(Xlr, Ylr);
+            BIGINT_PROFILE_TASK(BIGINT_TRACE_TASK("karatsuba", p3, P3 = par_karatsuba_mul_vector_open(Xlr, Ylr)));
         }
     }
 
+    BIGINT_PROFILE_JOIN_BEGIN(products);
     #pragma omp taskwait
+    BIGINT_PROFILE_JOIN_END(products);
     
+    BIGINT_PROFILE_BEGIN(interpolate);
     if (len >= PARALLEL_THRESHOLD / 4) {
         #pragma omp parallel for
         for (size_t i = 0; i < P3.size(); ++i) {
@@ -122,20 +142,26 @@ std::vector<long long> par_karatsuba_mul_vector_open(const std::vector<long long
             }
         }
     }
+    BIGINT_PROFILE_END(interpolate, PROFILE_INTERPOLATE, 80 * len);
 
     return res;
 }
 
 std::vector<long long> par_karatsuba_mul_vector_plib(const std::vector<long long>& x, const std::vector<long long>& y) {
     auto len = x.size();    
+    if (len <= SEQUENTIAL_THRESHOLD) {
+        return karatsuba_mul_vector(x, y);
+    }
     std::vector<long long> res(2 * len, 0);
-    
-    if (len <= KARATSUBA_THRESHOLD) {
-        return naive_mul_vector(x, y);
+    BIGINT_PROFILE_FRAME(len, 32 * len);
+
+    if (cancellation_requested()) {
+        return res;
     }
     
     auto k = len / 2;
     
+    BIGINT_PROFILE_BEGIN(evaluate);
     std::vector<long long> Xr(x.begin(), x.begin() + k);
     std::vector<long long> Xl(x.begin() + k, x.end());
     std::vector<long long> Yr(y.begin(), y.begin() + k);
@@ -145,7 +171,7 @@ std::vector<long long> par_karatsuba_mul_vector_plib(const std::vector<long long
     std::vector<long long> Xlr(k), Ylr(k);
 
     if (k >= PARALLEL_THRESHOLD / 4) {
-        parlay::parallel_for(0, k, [&](size_t i) {
+        bigint_parallel_for(0, k, [&](size_t i) {
             Xlr[i] = Xl[i] + Xr[i];
             Ylr[i] = Yl[i] + Yr[i];
         });
@@ -155,22 +181,24 @@ std::vector<long long> par_karatsuba_mul_vector_plib(const std::vector<long long
             Ylr[i] = Yl[i] + Yr[i];
         }
     }
+    BIGINT_PROFILE_END(evaluate, PROFILE_EVALUATE, 32 * len + 48 * k);
 
-    parlay::par_do(
+    bigint_par_do(
         [&]() { P1 = par_karatsuba_mul_vector_plib(Xl, Yl); },
-        [&]() {parlay::par_do(
+        [&]() {bigint_par_do(
             [&]() { P2 = par_karatsuba_mul_vector_plib(Xr, Yr); },
             [&]() { P3 = par_karatsuba_mul_vector_plib(Xlr, Ylr); } // Xlr, Ylr are ready
         );}
     );
     
+    BIGINT_PROFILE_BEGIN(interpolate);
     size_t max_size = std::max(P1.size(), P2.size());
     if (P3.size() < max_size) {
         P3.resize(max_size, 0);
     }
     
     if (len >= PARALLEL_THRESHOLD / 4) {
-        parlay::parallel_for(0, P3.size(), [&](size_t i) {
+        bigint_parallel_for(0, P3.size(), [&](size_t i) {
             if (i < P1.size()) P3[i] -= P1[i];
             if (i < P2.size()) P3[i] -= P2[i];
         });
@@ -186,17 +214,17 @@ std::vector<long long> par_karatsuba_mul_vector_plib(const std::vector<long long
     }
     
     if (len >= PARALLEL_THRESHOLD / 4) {
-        parlay::parallel_for(0, P2.size(), [&](size_t i) {
+        bigint_parallel_for(0, P2.size(), [&](size_t i) {
             res[i] += P2[i];
         });
 
-        parlay::parallel_for(0, P3.size(), [&](size_t i) {
+        bigint_parallel_for(0, P3.size(), [&](size_t i) {
             if (i + k < res.size()) {
                 res[i + k] += P3[i];
             }
         });
 
-        parlay::parallel_for(0, P1.size(), [&](size_t i) {
+        bigint_parallel_for(0, P1.size(), [&](size_t i) {
             if (i + len < res.size()) {
                 res[i + len] += P1[i];
             }
@@ -218,10 +246,15 @@ std::vector<long long> par_karatsuba_mul_vector_plib(const std::vector<long long
             }
         }
     }
+    BIGINT_PROFILE_END(interpolate, PROFILE_INTERPOLATE, 80 * len);
 
     return res;
 }
 
+std::vector<long long> par_karatsuba_mul_vector(const std::vector<long long>& x, const std::vector<long long>& y) {
+    return par_karatsuba_mul_vector_open(x, y);
+}
+
 std::string par_karatsuba_mul_string(const std::string &a, const std::string &b) {
     if (a.size() <= KARATSUBA_THRESHOLD || b.size() <= KARATSUBA_THRESHOLD) {
         return naive_mul_string(a, b);
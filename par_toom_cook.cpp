@@ -2,6 +2,8 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+
+#include "bigint_profile.h"
 #include <omp.h>
 
 using namespace std;
@@ -92,11 +94,16 @@ BigInt par_shift(const BigInt &a, int n) {
 
 BigInt par_toom_cook_mul_vector(const BigInt &x, const BigInt &y) {
     auto len = x.size();    
+    BIGINT_PROFILE_FRAME(len, 32 * len);
     
     if (len <= TOOM_COOK_THRESHOLD) {
-        return naive_mul_vector(x, y);
+        BIGINT_PROFILE_BEGIN(basecase);
+        BigInt base = naive_mul_vector(x, y);
+        BIGINT_PROFILE_END(basecase, PROFILE_BASECASE, 32 * len);
+        return base;
     }
     
+    BIGINT_PROFILE_BEGIN(evaluate);
     int k = (len + 2) / 3;
 
     // Split x and y into 3 parts each
@@ -125,34 +132,38 @@ BigInt par_toom_cook_mul_vector(const BigInt &x, const BigInt &y) {
     BigInt Qm1 = par_add(par_subtract(Y[2], Y[1]), Y[0]);
     BigInt Qm2 = par_add(par_subtract(Y[0], par_multiply_scalar(Y[1], 2)), par_multiply_scalar(Y[2], 4));
     BigInt Qinf = Y[2];
+    BIGINT_PROFILE_END(evaluate, PROFILE_EVALUATE, 8 * (4 * len + 30 * k));
 
     // Pointwise multiplications
     BigInt R0, R1, Rm1, Rm2, Rinf;
 
     if (len >= PARALLEL_THRESHOLD) {
+        BIGINT_PROFILE_JOIN_BEGIN(sections);
+        BIGINT_TRACE_SPAWN(sections);
         #pragma omp parallel sections
         {
             #pragma omp section
             {
-                R0 = par_toom_cook_mul_vector(P0, Q0);
+                BIGINT_PROFILE_TASK(BIGINT_TRACE_TASK("toom_cook", sections, R0 = par_toom_cook_mul_vector(P0, Q0)));
             }
             #pragma omp section
             {
-                R1 = par_toom_cook_mul_vector(P1, Q1);
+                BIGINT_PROFILE_TASK(BIGINT_TRACE_TASK("toom_cook", sections, R1 = par_toom_cook_mul_vector(P1, Q1)));
             }
             #pragma omp section
             {
-                Rm1 = par_toom_cook_mul_vector(Pm1, Qm1);
+                BIGINT_PROFILE_TASK(BIGINT_TRACE_TASK("toom_cook", sections, Rm1 = par_toom_cook_mul_vector(Pm1, Qm1)));
             }
             #pragma omp section
             {
-                Rm2 = par_toom_cook_mul_vector(Pm2, Qm2);
+                BIGINT_PROFILE_TASK(BIGINT_TRACE_TASK("toom_cook", sections, Rm2 = par_toom_cook_mul_vector(Pm2, Qm2)));
             }
             #pragma omp section
             {
-                Rinf = par_toom_cook_mul_vector(Pinf, Qinf);
+                BIGINT_PROFILE_TASK(BIGINT_TRACE_TASK("toom_cook", sections, Rinf = par_toom_cook_mul_vector(Pinf, Qinf)));
             }
         }
+        BIGINT_PROFILE_JOIN_END(sections);
     } else {
         R0 = par_toom_cook_mul_vector(P0, Q0);
         R1 = par_toom_cook_mul_vector(P1, Q1);
@@ -162,6 +173,7 @@ BigInt par_toom_cook_mul_vector(const BigInt &x, const BigInt &y) {
     }
 
     // Interpolation
+    BIGINT_PROFILE_BEGIN(interpolate);
     BigInt r0 = R0;
     BigInt r4 = Rinf;
     BigInt r3 = par_divide_scalar(par_subtract(Rm2, R1), 3);
@@ -177,6 +189,7 @@ BigInt par_toom_cook_mul_vector(const BigInt &x, const BigInt &y) {
     result = par_add(result, par_shift(r2, 2 * k));
     result = par_add(result, par_shift(r3, 3 * k));
     result = par_add(result, par_shift(r4, 4 * k));
+    BIGINT_PROFILE_END(interpolate, PROFILE_INTERPOLATE, 8 * 60 * k);
     
     return result;
 }
@@ -8,6 +8,8 @@
 #include "parlaylib/include/parlay/sequence.h"
 #include "parlaylib/include/parlay/utilities.h"
 
+#include "bigint_profile.h"
+
 
 using namespace std;
 
@@ -20,7 +22,7 @@ BigInt par_add_plib(const BigInt &a, const BigInt &b) {
     BigInt res(max(a.size(), b.size()));
     
     if (res.size() >= PARALLEL_THRESHOLD / 4) {
-        parlay::parallel_for(0, res.size(), [&](size_t i) {
+        bigint_parallel_for(0, res.size(), [&](size_t i) {
             auto x = i < a.size() ? a[i] : 0;
             auto y = i < b.size() ? b[i] : 0;
             res[i] = x + y;
@@ -39,7 +41,7 @@ BigInt par_subtract_plib(const BigInt &a, const BigInt &b) {
     BigInt res(max(a.size(), b.size()));
 
     if (res.size() >= PARALLEL_THRESHOLD / 4) {
-        parlay::parallel_for(0, res.size(), [&](size_t i) {
+        bigint_parallel_for(0, res.size(), [&](size_t i) {
             auto x = i < a.size() ? a[i] : 0;
             auto y = i < b.size() ? b[i] : 0;
             res[i] = x - y;
@@ -58,7 +60,7 @@ BigInt par_multiply_scalar_plib(const BigInt &a, int scalar) {
     BigInt res(a.size());
 
     if (res.size() >= PARALLEL_THRESHOLD / 4) {
-        parlay::parallel_for(0, res.size(), [&](size_t i) {
+        bigint_parallel_for(0, res.size(), [&](size_t i) {
             res[i] = a[i] * scalar;
         });
     } else {
@@ -73,7 +75,7 @@ BigInt par_divide_scalar_plib(const BigInt &a, int scalar) {
     BigInt res(a.size());
 
     if (res.size() >= PARALLEL_THRESHOLD / 4) {
-        parlay::parallel_for(0, res.size(), [&](size_t i) {
+        bigint_parallel_for(0, res.size(), [&](size_t i) {
             res[i] = a[i] / scalar;
         });
     } else {
@@ -91,68 +93,27 @@ BigInt par_shift_plib(const BigInt &a, int n) {
     return res;
 }
 
-BigInt par_toom_cook_mul_vector_plib(const BigInt &x, const BigInt &y) {
-    auto len = x.size();    
-    
-    if (len <= TOOM_COOK_THRESHOLD) {
-        return naive_mul_vector(x, y);
+// Split num into 3 parts of k digits and evaluate at 0, 1, -1, -2, inf
+static array<BigInt, 5> evaluate_plib(const BigInt &num, int k) {
+    array<BigInt, 3> X = {};
+    for (int i = 0; i < 3; i++) {
+        int start = i * k;
+        int end = min((i + 1) * k, (int)num.size());
+        X[i] = BigInt(num.begin() + start, num.begin() + end);
     }
-    
-    int k = (len + 2) / 3;
 
-    // Split x and y into 3 parts each
-    auto split = [&](const BigInt &num) -> array<BigInt, 3> {
-        array<BigInt, 3> parts = {};
-        for (int i = 0; i < 3; i++) {
-            int start = i * k;
-            int end = min((i + 1) * k, (int)num.size());
-            parts[i] = BigInt(num.begin() + start, num.begin() + end);
-        }
-        return parts;
+    return {
+        X[0],
+        par_add_plib(par_add_plib(X[2], X[1]), X[0]),
+        par_add_plib(par_subtract_plib(X[2], X[1]), X[0]),
+        par_add_plib(par_subtract_plib(X[0], par_multiply_scalar_plib(X[1], 2)), par_multiply_scalar_plib(X[2], 4)),
+        X[2],
     };
+}
 
-    auto X = split(x);
-    auto Y = split(y);
-
-    // Evaluate at 5 points
-    BigInt P0 = X[0];
-    BigInt P1 = par_add_plib(par_add_plib(X[2], X[1]), X[0]);
-    BigInt Pm1 = par_add_plib(par_subtract_plib(X[2], X[1]), X[0]);
-    BigInt Pm2 = par_add_plib(par_subtract_plib(X[0], par_multiply_scalar_plib(X[1], 2)), par_multiply_scalar_plib(X[2], 4));
-    BigInt Pinf = X[2];
-
-    BigInt Q0 = Y[0];
-    BigInt Q1 = par_add_plib(par_add_plib(Y[2], Y[1]), Y[0]);
-    BigInt Qm1 = par_add_plib(par_subtract_plib(Y[2], Y[1]), Y[0]);
-    BigInt Qm2 = par_add_plib(par_subtract_plib(Y[0], par_multiply_scalar_plib(Y[1], 2)), par_multiply_scalar_plib(Y[2], 4));
-    BigInt Qinf = Y[2];
-
-    // Pointwise multiplications
-    BigInt R0, R1, Rm1, Rm2, Rinf;
+static BigInt interpolate_plib(const array<BigInt, 5> &R, int k) {
+    const BigInt &R0 = R[0], &R1 = R[1], &Rm1 = R[2], &Rm2 = R[3], &Rinf = R[4];
 
-    if (len >= PARALLEL_THRESHOLD) {
-        parlay::par_do(
-            [&]() { R0 = par_toom_cook_mul_vector_plib(P0, Q0); },
-            [&]() {parlay::par_do(
-                [&]() { R1 = par_toom_cook_mul_vector_plib(P1, Q1); },
-                [&]() {parlay::par_do(
-                    [&]() { Rm1 = par_toom_cook_mul_vector_plib(Pm1, Qm1); },
-                    [&]() {parlay::par_do(
-                        [&]() { Rm2 = par_toom_cook_mul_vector_plib(Pm2, Qm2); },
-                        [&]() { Rinf = par_toom_cook_mul_vector_plib(Pinf, Qinf); }
-                    );}
-                );}
-            );}
-        );
-    } else {
-        R0 = par_toom_cook_mul_vector_plib(P0, Q0);
-        R1 = par_toom_cook_mul_vector_plib(P1, Q1);
-        Rm1 = par_toom_cook_mul_vector_plib(Pm1, Qm1);
-        Rm2 = par_toom_cook_mul_vector_plib(Pm2, Qm2);
-        Rinf = par_toom_cook_mul_vector_plib(Pinf, Qinf);
-    }
-
-    // Interpolation
     BigInt r0 = R0;
     BigInt r4 = Rinf;
     BigInt r3 = par_divide_scalar_plib(par_subtract_plib(Rm2, R1), 3);
@@ -168,10 +129,110 @@ BigInt par_toom_cook_mul_vector_plib(const BigInt &x, const BigInt &y) {
     result = par_add_plib(result, par_shift_plib(r2, 2 * k));
     result = par_add_plib(result, par_shift_plib(r3, 3 * k));
     result = par_add_plib(result, par_shift_plib(r4, 4 * k));
+
+    return result;
+}
+
+// Pointwise multiplications R[i] = mul(i), in parallel for large operands
+template <typename F>
+static array<BigInt, 5> pointwise_plib(size_t len, F&& mul) {
+    array<BigInt, 5> R;
+
+    if (len >= PARALLEL_THRESHOLD) {
+        bigint_par_do(
+            [&]() { R[0] = mul(0); },
+            [&]() {bigint_par_do(
+                [&]() { R[1] = mul(1); },
+                [&]() {bigint_par_do(
+                    [&]() { R[2] = mul(2); },
+                    [&]() {bigint_par_do(
+                        [&]() { R[3] = mul(3); },
+                        [&]() { R[4] = mul(4); }
+                    );}
+                );}
+            );}
+        );
+    } else {
+        for (size_t i = 0; i < 5; i++) {
+            R[i] = mul(i);
+        }
+    }
+    return R;
+}
+
+BigInt par_toom_cook_mul_vector_plib(const BigInt &x, const BigInt &y) {
+    auto len = x.size();    
+    BIGINT_PROFILE_FRAME(len, 32 * len);
+    
+    if (len <= TOOM_COOK_THRESHOLD) {
+        BIGINT_PROFILE_BEGIN(basecase);
+        BigInt base = naive_mul_vector(x, y);
+        BIGINT_PROFILE_END(basecase, PROFILE_BASECASE, 32 * len);
+        return base;
+    }
+    if (cancellation_requested()) {
+        return BigInt(2 * len, 0);
+    }
     
+    int k = (len + 2) / 3;
+
+    BIGINT_PROFILE_BEGIN(evaluate);
+    auto P = evaluate_plib(x, k);
+    auto Q = evaluate_plib(y, k);
+    BIGINT_PROFILE_END(evaluate, PROFILE_EVALUATE, 8 * (4 * len + 30 * k));
+
+    auto R = pointwise_plib(len, [&](size_t i) { return par_toom_cook_mul_vector_plib(P[i], Q[i]); });
+
+    BIGINT_PROFILE_BEGIN(interpolate);
+    BigInt result = interpolate_plib(R, k);
+    BIGINT_PROFILE_END(interpolate, PROFILE_INTERPOLATE, 8 * 60 * k);
     return result;
 }
 
+// Evaluates x recursively down to max_depth levels (or the basecase), so
+// that repeated products with x skip its half of the evaluation work.
+toom_cook_evaluation par_toom_cook_evaluate_plib(const BigInt &x, size_t max_depth) {
+    toom_cook_evaluation node;
+    node.length = x.size();
+
+    if (x.size() <= TOOM_COOK_THRESHOLD || max_depth == 0) {
+        node.value = x;
+        return node;
+    }
+
+    int k = (x.size() + 2) / 3;
+    auto P = evaluate_plib(x, k);
+
+    node.points.resize(5);
+    if (x.size() >= PARALLEL_THRESHOLD) {
+        bigint_parallel_for(0, 5, [&](size_t i) {
+            node.points[i] = par_toom_cook_evaluate_plib(P[i], max_depth - 1);
+        }, 1);
+    } else {
+        for (size_t i = 0; i < 5; i++) {
+            node.points[i] = par_toom_cook_evaluate_plib(P[i], max_depth - 1);
+        }
+    }
+    return node;
+}
+
+// Same recursion as par_toom_cook_mul_vector_plib with x already evaluated;
+// y must have x's length.
+BigInt par_toom_cook_mul_vector_prepared_plib(const toom_cook_evaluation &x, const BigInt &y) {
+    if (x.points.empty()) {
+        return par_toom_cook_mul_vector_plib(x.value, y);
+    }
+
+    auto len = y.size();
+    int k = (len + 2) / 3;
+
+    auto Q = evaluate_plib(y, k);
+
+    auto R = pointwise_plib(len, [&](size_t i) { return par_toom_cook_mul_vector_prepared_plib(x.points[i], Q[i]); });
+
+    return interpolate_plib(R, k);
+}
+
 std::string par_toom_cook_mul_string_plib(const std::string &a, const std::string &b) {
     if (a.size() <= TOOM_COOK_THRESHOLD || b.size() <= TOOM_COOK_THRESHOLD) {
         return naive_mul_string(a, b);
@@ -0,0 +1,147 @@
+#include "bigint_multiply.h"
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cerrno>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+
+struct event_spec {
+    uint32_t type;
+    uint64_t config;
+};
+
+// In the order of the perf_sample fields.
+static const event_spec EVENTS[perf_counters::NUM_EVENTS] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+};
+
+static int open_event(const event_spec& e, pid_t tid) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = e.type;
+    attr.config = e.config;
+    attr.disabled = 1;
+    attr.inherit = 1;  // also count threads the worker spawns later
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, tid, -1, -1, 0));
+}
+
+// Thread ids of the process. Worker pools (OpenMP, parlay) are created once
+// and reused, so the threads running the next multiply already exist.
+static std::vector<pid_t> process_threads() {
+    std::vector<pid_t> tids;
+    if (DIR* dir = opendir("/proc/self/task")) {
+        while (dirent* entry = readdir(dir)) {
+            if (entry->d_name[0] != '.') {
+                tids.push_back(static_cast<pid_t>(std::stol(entry->d_name)));
+            }
+        }
+        closedir(dir);
+    }
+    if (tids.empty()) {
+        tids.push_back(0);  // the calling thread
+    }
+    return tids;
+}
+
+void perf_counters::start() {
+    close_all();
+    for (pid_t tid : process_threads()) {
+        for (size_t e = 0; e < NUM_EVENTS; ++e) {
+            int fd = open_event(EVENTS[e], tid);
+            if (fd >= 0) {
+                fds[e].push_back(fd);
+            } else if (fds[e].empty() && error_message.empty()) {
+                error_message = std::string("perf_event_open: ") + std::strerror(errno);
+            }
+        }
+    }
+    for (auto& event_fds : fds) {
+        for (int fd : event_fds) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+perf_sample perf_counters::stop() {
+    for (auto& event_fds : fds) {
+        for (int fd : event_fds) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+
+    long long totals[NUM_EVENTS];
+    for (size_t e = 0; e < NUM_EVENTS; ++e) {
+        totals[e] = fds[e].empty() ? -1 : 0;
+        for (int fd : fds[e]) {
+            // value, time enabled, time running. The value is scaled up when
+            // the PMU had to multiplex more events than it has counters.
+            uint64_t buf[3];
+            if (read(fd, buf, sizeof(buf)) != sizeof(buf)) {
+                continue;
+            }
+            double scale = buf[2] > 0 ? double(buf[1]) / buf[2] : 1.0;
+            totals[e] += static_cast<long long>(buf[0] * scale);
+        }
+    }
+    close_all();
+
+    perf_sample s;
+    s.cycles = totals[0];
+    s.instructions = totals[1];
+    s.llc_misses = totals[2];
+    s.dtlb_misses = totals[3];
+    s.branch_misses = totals[4];
+    s.task_clock_ns = totals[5];
+    return s;
+}
+
+void perf_counters::close_all() {
+    for (auto& event_fds : fds) {
+        for (int fd : event_fds) {
+            close(fd);
+        }
+        event_fds.clear();
+    }
+}
+
+#else
+
+void perf_counters::start() {
+    error_message = "perf_event_open is only available on Linux";
+}
+
+perf_sample perf_counters::stop() {
+    return {};
+}
+
+void perf_counters::close_all() {}
+
+#endif
+
+perf_counters::~perf_counters() {
+    close_all();
+}
+
+double perf_sample::ipc() const {
+    return cycles > 0 && instructions >= 0 ? double(instructions) / cycles : -1;
+}
@@ -0,0 +1,62 @@
+#include "bigint_multiply.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+
+static constexpr size_t BASECASE_THRESHOLD = 64;
+
+// Each evaluated level stores 5/3 of the digits of the level above, so the
+// tree is cut off once it would hold this many times the operand's size.
+static constexpr size_t MAX_EVALUATION_GROWTH = 16;
+
+static size_t evaluation_depth(size_t len) {
+    size_t depth = 0;
+    size_t stored = len;
+    while (len > BASECASE_THRESHOLD && stored * 5 / 3 <= MAX_EVALUATION_GROWTH * len) {
+        len = (len + 2) / 3;
+        stored = stored * 5 / 3;
+        ++depth;
+    }
+    return depth;
+}
+
+prepared_multiplicand::prepared_multiplicand(const std::vector<long long>& operand) : digits(operand) {
+    normalize_vector(digits);
+    evaluation = par_toom_cook_evaluate_plib(digits, evaluation_depth(digits.size()));
+}
+
+prepared_multiplicand::prepared_multiplicand(const std::string& operand)
+    : prepared_multiplicand(string_to_vector(operand)) {}
+
+// Products with operands up to our length pad them to it; longer operands are
+// cut into pieces of our length that all reuse the same evaluation tree. An
+// operand less than half our length would pay for a full n-digit product
+// that way, so it goes to mul_vector, which cuts our digits into pieces of
+// its length instead, the same rule mul_vector applies itself.
+std::vector<long long> prepared_multiplicand::multiply(const std::vector<long long>& y) const {
+    size_t n = digits.size();
+    if (2 * y.size() <= n) {
+        return mul_vector(digits, y);
+    }
+    std::vector<long long> res(y.size() + n + 1, 0);
+
+    for (size_t start = 0; start < y.size(); start += n) {
+        size_t end = std::min(start + n, y.size());
+        std::vector<long long> piece(y.begin() + start, y.begin() + end);
+        piece.resize(n, 0);
+
+        std::vector<long long> p = par_toom_cook_mul_vector_prepared_plib(evaluation, piece);
+        for (size_t i = 0; i < p.size() && start + i < res.size(); ++i) {
+            res[start + i] += p[i];
+        }
+    }
+
+    normalize_vector(res);
+    return res;
+}
+
+std::string prepared_multiplicand::multiply(const std::string& y) const {
+    std::vector<long long> y_vec = string_to_vector(y);
+    normalize_vector(y_vec);
+    return vector_to_string(multiply(y_vec));
+}
@@ -0,0 +1,66 @@
+#include "bigint_multiply.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include "parlaylib/include/parlay/parallel.h"
+
+#include "bigint_profile.h"
+
+static constexpr size_t PARALLEL_THRESHOLD = 10000;
+
+using Factors = std::vector<std::vector<long long>>;
+
+// Multiplies factors[lo, hi). The range is split where the running digit count
+// crosses half of the range's total, so both children carry similar work even
+// when the factor sizes are skewed. prefix[i] is the digit count of factors[0, i).
+static std::vector<long long> product_range(const Factors& factors, const std::vector<size_t>& prefix,
+                                            size_t lo, size_t hi) {
+    if (hi - lo == 1) {
+        std::vector<long long> leaf(factors[lo]);
+        normalize_vector(leaf);
+        return leaf;
+    }
+
+    size_t half = prefix[lo] + (prefix[hi] - prefix[lo]) / 2;
+    size_t mid = std::upper_bound(prefix.begin() + lo + 1, prefix.begin() + hi, half) - prefix.begin();
+    mid = std::clamp(mid, lo + 1, hi - 1);
+
+    std::vector<long long> left, right;
+    if (prefix[hi] - prefix[lo] >= PARALLEL_THRESHOLD) {
+        bigint_par_do(
+            [&]() { left = product_range(factors, prefix, lo, mid); },
+            [&]() { right = product_range(factors, prefix, mid, hi); }
+        );
+    } else {
+        left = product_range(factors, prefix, lo, mid);
+        right = product_range(factors, prefix, mid, hi);
+    }
+
+    return mul_vector(left, right);
+}
+
+std::vector<long long> product_mul_vector(const Factors& factors) {
+    if (factors.empty()) {
+        return {1};
+    }
+
+    std::vector<size_t> prefix(factors.size() + 1, 0);
+    for (size_t i = 0; i < factors.size(); ++i) {
+        prefix[i + 1] = prefix[i] + factors[i].size();
+    }
+
+    return product_range(factors, prefix, 0, factors.size());
+}
+
+std::string product_mul_string(const std::vector<std::string>& factors) {
+    Factors vecs(factors.size());
+    parlay::parallel_for(0, factors.size(), [&](size_t i) {
+        vecs[i].resize(factors[i].size());
+        for (size_t j = 0; j < factors[i].size(); ++j) {
+            vecs[i][factors[i].size() - 1 - j] = factors[i][j] - '0';
+        }
+    });
+
+    return vector_to_string(product_mul_vector(vecs));
+}
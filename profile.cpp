@@ -0,0 +1,105 @@
+#include "bigint_profile.h"
+#include <vector>
+#include <array>
+#include <iomanip>
+
+#ifdef BIGINT_PROFILE
+
+#include "parlaylib/include/parlay/thread_specific.h"
+
+struct profile_level {
+    size_t calls = 0;
+    size_t length = 0;  // summed over calls
+    size_t bytes = 0;
+    double inclusive = 0;
+    std::array<double, PROFILE_NUM_PHASES> seconds = {};
+};
+
+using profile_table = std::vector<profile_level>;
+
+static parlay::ThreadSpecific<profile_table> tables;
+
+size_t& profile_current_depth() {
+    static thread_local size_t depth = 0;
+    return depth;
+}
+
+double& profile_task_seconds() {
+    static thread_local double seconds = 0;
+    return seconds;
+}
+
+static profile_level& local_level(size_t depth) {
+    profile_table& table = *tables;
+    if (table.size() <= depth) {
+        table.resize(depth + 1);
+    }
+    return table[depth];
+}
+
+void profile_record(size_t depth, profile_phase phase, double seconds, size_t bytes) {
+    profile_level& level = local_level(depth);
+    level.seconds[phase] += seconds;
+    level.bytes += bytes;
+}
+
+void profile_record_call(size_t depth, size_t length, double seconds, size_t bytes) {
+    profile_level& level = local_level(depth);
+    level.calls += 1;
+    level.length += length;
+    level.inclusive += seconds;
+    level.bytes += bytes;
+}
+
+void profile_reset() {
+    tables.for_each([](profile_table& table) { table.clear(); });
+}
+
+// Times are summed over calls and threads, so with several workers a level
+// can add up to more than the wall time of the run.
+void profile_report(std::ostream& out) {
+    profile_table total;
+    tables.for_each([&](profile_table& table) {
+        if (total.size() < table.size()) {
+            total.resize(table.size());
+        }
+        for (size_t d = 0; d < table.size(); ++d) {
+            total[d].calls += table[d].calls;
+            total[d].length += table[d].length;
+            total[d].bytes += table[d].bytes;
+            total[d].inclusive += table[d].inclusive;
+            for (size_t p = 0; p < PROFILE_NUM_PHASES; ++p) {
+                total[d].seconds[p] += table[d].seconds[p];
+            }
+        }
+    });
+
+    static const char* PHASE_NAMES[PROFILE_NUM_PHASES] = {"basecase", "evaluate", "interp", "carry", "join"};
+    out << "  Recursion profile (seconds summed over calls and threads):\n"
+        << "  " << std::setw(5) << "depth" << std::setw(10) << "calls" << std::setw(10) << "avg len"
+        << std::setw(11) << "inclusive";
+    for (const char* name : PHASE_NAMES) {
+        out << std::setw(10) << name;
+    }
+    out << std::setw(12) << "MiB touched" << "\n";
+
+    auto flags = out.flags();
+    for (size_t d = 0; d < total.size(); ++d) {
+        const profile_level& level = total[d];
+        out << "  " << std::setw(5) << d << std::setw(10) << level.calls << std::setw(10)
+            << (level.calls ? level.length / level.calls : 0) << std::fixed << std::setprecision(4)
+            << std::setw(11) << level.inclusive;
+        for (double s : level.seconds) {
+            out << std::setw(10) << s;
+        }
+        out << std::setprecision(1) << std::setw(12) << level.bytes / double(1 << 20) << "\n";
+    }
+    out.flags(flags);
+}
+
+#else
+
+void profile_reset() {}
+void profile_report(std::ostream&) {}
+
+#endif
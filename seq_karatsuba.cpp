@@ -3,26 +3,35 @@
 #include <string>
 #include <algorithm>
 
+#include "bigint_profile.h"
+
 static constexpr size_t KARATSUBA_THRESHOLD = 64;
 
 std::vector<long long> karatsuba_mul_vector(const std::vector<long long>& x, const std::vector<long long>& y) {
     auto len = x.size();    
     std::vector<long long> res(2 * len);
+    BIGINT_PROFILE_FRAME(len, 32 * len);
     
     if (len <= KARATSUBA_THRESHOLD) {
-        return naive_mul_vector(x, y);
+        BIGINT_PROFILE_BEGIN(basecase);
+        std::vector<long long> base = naive_mul_vector(x, y);
+        BIGINT_PROFILE_END(basecase, PROFILE_BASECASE, 32 * len);
+        return base;
     }
     
     auto k = len / 2;
     
+    BIGINT_PROFILE_BEGIN(split);
     std::vector<long long> Xr(x.begin(), x.begin() + k);
     std::vector<long long> Xl(x.begin() + k, x.end());
     std::vector<long long> Yr(y.begin(), y.begin() + k);
     std::vector<long long> Yl(y.begin() + k, y.end());
+    BIGINT_PROFILE_END(split, PROFILE_EVALUATE, 32 * len);
     
     std::vector<long long> P1 = karatsuba_mul_vector(Xl, Yl);
     std::vector<long long> P2 = karatsuba_mul_vector(Xr, Yr);
     
+    BIGINT_PROFILE_BEGIN(evaluate);
     std::vector<long long> Xlr(k);
     std::vector<long long> Ylr(k);
     
@@ -30,9 +39,11 @@ std::vector<long long> karatsuba_mul_vector(const std::vector<long long>& x, con
         Xlr[i] = Xl[i] + Xr[i];
         Ylr[i] = Yl[i] + Yr[i];
     }
+    BIGINT_PROFILE_END(evaluate, PROFILE_EVALUATE, 48 * k);
     
     std::vector<long long> P3 = karatsuba_mul_vector(Xlr, Ylr);
     
+    BIGINT_PROFILE_BEGIN(interpolate);
     for (auto i = 0; i < len; ++i) {
         P3[i] -= P2[i] + P1[i];
     }
@@ -47,6 +58,7 @@ std::vector<long long> karatsuba_mul_vector(const std::vector<long long>& x, con
     for (auto i = k; i < len + k; ++i) {
         res[i] += P3[i - k];
     }
+    BIGINT_PROFILE_END(interpolate, PROFILE_INTERPOLATE, 80 * len);
     
     return res;
 }
@@ -68,4 +80,136 @@ std::string karatsuba_mul_string(const std::string &a, const std::string &b) {
     std::vector<long long> result_vec = karatsuba_mul_vector(a_vec, b_vec);
     
     return vector_to_string(result_vec);
-}
\ No newline at end of file
+}
+static bool is_power_of_2(size_t n) {
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+// Low half of x * y (coefficients 0..n-1) for equal-length x and y.
+// Mulders' split: with p = 3n/4 the low half is the full product of the low p
+// coefficients plus two short products of the remaining n/4, so the top
+// quarter-by-quarter product is never formed. Lengths that are not powers
+// of two are padded, which leaves the low coefficients unchanged.
+std::vector<long long> karatsuba_mullo_vector(const std::vector<long long>& x, const std::vector<long long>& y) {
+    size_t n = x.size();
+
+    if (n <= KARATSUBA_THRESHOLD) {
+        return naive_mullo_vector(x, y);
+    }
+
+    if (!is_power_of_2(n)) {
+        size_t pow2 = 1;
+        while (pow2 < n) pow2 *= 2;
+        std::vector<long long> xp(x), yp(y);
+        xp.resize(pow2, 0);
+        yp.resize(pow2, 0);
+        std::vector<long long> res = karatsuba_mullo_vector(xp, yp);
+        res.resize(n);
+        return res;
+    }
+
+    size_t p = 3 * n / 4;
+    size_t q = n - p;
+
+    std::vector<long long> Xl(x.begin(), x.begin() + p);
+    std::vector<long long> Yl(y.begin(), y.begin() + p);
+    std::vector<long long> full = karatsuba_mul_vector(Xl, Yl);
+
+    std::vector<long long> res(full.begin(), full.begin() + n);
+
+    std::vector<long long> Xh(x.begin() + p, x.end());
+    std::vector<long long> Yh(y.begin() + p, y.end());
+    std::vector<long long> Xq(x.begin(), x.begin() + q);
+    std::vector<long long> Yq(y.begin(), y.begin() + q);
+    std::vector<long long> C1 = karatsuba_mullo_vector(Xh, Yq);
+    std::vector<long long> C2 = karatsuba_mullo_vector(Xq, Yh);
+
+    for (size_t i = 0; i < q; ++i) {
+        res[p + i] += C1[i] + C2[i];
+    }
+
+    return res;
+}
+
+// High half of x * y (coefficients n-1..2n-2). Reversing both operands
+// reverses the product, so this is the low half of the reversed operands.
+std::vector<long long> karatsuba_mulhi_vector(const std::vector<long long>& x, const std::vector<long long>& y) {
+    std::vector<long long> xr(x.rbegin(), x.rend());
+    std::vector<long long> yr(y.rbegin(), y.rend());
+    std::vector<long long> res = karatsuba_mullo_vector(xr, yr);
+    std::reverse(res.begin(), res.end());
+    return res;
+}
+
+// res[t] = sum_j x[t + j] * v[j] for |x| = 2n-1, |v| = n. This is a Hankel
+// matrix-vector product; splitting the matrix into 2x2 blocks
+//     [A B] [v0]   [p1 + p2]     p1 = B (v0 + v1)
+//     [B C] [v1] = [p1 + p3],    p2 = (A - B) v0,  p3 = (C - B) v1
+// needs three half-size products, like Karatsuba.
+static std::vector<long long> karatsuba_hankel(const std::vector<long long>& x, const std::vector<long long>& v) {
+    size_t n = v.size();
+    std::vector<long long> res(n, 0);
+
+    if (n <= KARATSUBA_THRESHOLD || n % 2 != 0) {
+        for (size_t t = 0; t < n; ++t) {
+            for (size_t j = 0; j < n; ++j) {
+                res[t] += x[t + j] * v[j];
+            }
+        }
+        return res;
+    }
+
+    size_t k = n / 2;
+
+    std::vector<long long> X1(x.begin() + k, x.begin() + 3 * k - 1);
+    std::vector<long long> X01(2 * k - 1), X21(2 * k - 1);
+    for (size_t i = 0; i < 2 * k - 1; ++i) {
+        X01[i] = x[i] - x[k + i];
+        X21[i] = x[2 * k + i] - x[k + i];
+    }
+
+    std::vector<long long> V0(v.begin(), v.begin() + k);
+    std::vector<long long> V1(v.begin() + k, v.end());
+    std::vector<long long> V01(k);
+    for (size_t i = 0; i < k; ++i) {
+        V01[i] = V0[i] + V1[i];
+    }
+
+    std::vector<long long> P1 = karatsuba_hankel(X1, V01);
+    std::vector<long long> P2 = karatsuba_hankel(X01, V0);
+    std::vector<long long> P3 = karatsuba_hankel(X21, V1);
+
+    for (size_t i = 0; i < k; ++i) {
+        res[i] = P1[i] + P2[i];
+        res[k + i] = P1[i] + P3[i];
+    }
+
+    return res;
+}
+
+// Middle product: coefficients n-1..2n-2 of x * y where |y| = n and
+// |x| = 2n-1, in the time of one n-by-n Karatsuba product. Odd lengths are
+// padded by shifting y up, which moves the wanted window onto the padded one.
+std::vector<long long> karatsuba_middle_product_vector(const std::vector<long long>& x, const std::vector<long long>& y) {
+    size_t n = y.size();
+
+    if (n <= KARATSUBA_THRESHOLD) {
+        return naive_middle_product_vector(x, y);
+    }
+
+    size_t pow2 = 1;
+    while (pow2 < n) pow2 *= 2;
+
+    std::vector<long long> xp(x.begin(), x.begin() + (2 * n - 1));
+    xp.resize(2 * pow2 - 1, 0);
+
+    // v is y shifted up by pow2 - n and then reversed.
+    std::vector<long long> v(pow2, 0);
+    for (size_t j = 0; j < n; ++j) {
+        v[n - 1 - j] = y[j];
+    }
+
+    std::vector<long long> res = karatsuba_hankel(xp, v);
+    res.resize(n);
+    return res;
+}
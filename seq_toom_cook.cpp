@@ -3,6 +3,8 @@
 #include <string>
 #include <algorithm>
 
+#include "bigint_profile.h"
+
 using namespace std;
 
 using BigInt = vector<long long>;
@@ -54,11 +56,16 @@ BigInt shift(const BigInt &a, int n) {
 
 BigInt toom_cook_mul_vector(const BigInt &x, const BigInt &y) {
     auto len = x.size();    
+    BIGINT_PROFILE_FRAME(len, 32 * len);
     
     if (len <= TOOM_COOK_THRESHOLD) {
-        return naive_mul_vector(x, y);
+        BIGINT_PROFILE_BEGIN(basecase);
+        BigInt base = naive_mul_vector(x, y);
+        BIGINT_PROFILE_END(basecase, PROFILE_BASECASE, 32 * len);
+        return base;
     }
     
+    BIGINT_PROFILE_BEGIN(evaluate);
     int k = (len + 2) / 3;
 
     // Split x and y into 3 parts each
@@ -87,6 +94,7 @@ BigInt toom_cook_mul_vector(const BigInt &x, const BigInt &y) {
     BigInt Qm1 = add(subtract(Y[2], Y[1]), Y[0]);
     BigInt Qm2 = add(subtract(Y[0], multiply_scalar(Y[1], 2)), multiply_scalar(Y[2], 4));
     BigInt Qinf = Y[2];
+    BIGINT_PROFILE_END(evaluate, PROFILE_EVALUATE, 8 * (4 * len + 30 * k));
 
     // Pointwise multiplications
     BigInt R0 = toom_cook_mul_vector(P0, Q0);
@@ -96,6 +104,7 @@ BigInt toom_cook_mul_vector(const BigInt &x, const BigInt &y) {
     BigInt Rinf = toom_cook_mul_vector(Pinf, Qinf);
 
     // Interpolation
+    BIGINT_PROFILE_BEGIN(interpolate);
     BigInt r0 = R0;
     BigInt r4 = Rinf;
     BigInt r3 = divide_scalar(subtract(Rm2, R1), 3);
@@ -111,6 +120,7 @@ BigInt toom_cook_mul_vector(const BigInt &x, const BigInt &y) {
     result = add(result, shift(r2, 2 * k));
     result = add(result, shift(r3, 3 * k));
     result = add(result, shift(r4, 4 * k));
+    BIGINT_PROFILE_END(interpolate, PROFILE_INTERPOLATE, 8 * 60 * k);
     
     return result;
 }
@@ -3,15 +3,27 @@
 #include <chrono>
 #include <iomanip>
 #include <string>
+#include <sstream>
 #include <algorithm>
+#include <array>
+#include <random>
+#include <cmath>
+#include <fstream>
 #include <omp.h>
 
+#include "parlaylib/include/parlay/random.h"
+
+#include "bigint_profile.h"
+#include "bigint_trace.h"
+
 enum class Algorithm {
     NAIVE = 0,
     KARATSUBA_SEQ = 1,
     KARATSUBA_PAR = 2,
     TOOM_COOK_SEQ = 3,
     TOOM_COOK_PAR = 4,
+    KARATSUBA_PAR_PLIB = 5,
+    TOOM_COOK_PAR_PLIB = 6,
 };
 
 std::string algorithm_to_string(Algorithm alg) {
@@ -21,20 +33,44 @@ std::string algorithm_to_string(Algorithm alg) {
         case Algorithm::KARATSUBA_PAR: return "Karatsuba Parallel";
         case Algorithm::TOOM_COOK_SEQ: return "Toom Cook Sequential";
         case Algorithm::TOOM_COOK_PAR: return "Toom Cook Parallel";
+        case Algorithm::KARATSUBA_PAR_PLIB: return "Karatsuba Parallel (ParlayLib)";
+        case Algorithm::TOOM_COOK_PAR_PLIB: return "Toom Cook Parallel (ParlayLib)";
         default: return "Unknown";
     }
 }
 
+enum class VerifyMode {
+    CROSS,    // compare algorithms against each other
+    MODULAR,  // check every result modulo random primes
+    BOTH,
+};
+
+static constexpr size_t MODULAR_CHECK_ROUNDS = 4;
+
 bool verify_results(const std::string& a, const std::string& b,
-                    const std::vector<std::string>& results,
-                    const std::vector<Algorithm>& algorithms) {
+                    const std::vector<decimal_view>& results,
+                    const std::vector<Algorithm>& algorithms,
+                    VerifyMode mode, size_t seed) {
     if (results.empty()) {
         return true; // Nothing to verify if no results
     }
 
-    const std::string& first_result = results[0];
+    const decimal_view& first_result = results[0];
     bool all_match = true;
 
+    if (mode != VerifyMode::CROSS) {
+        for (size_t i = 0; i < results.size(); ++i) {
+            if (!modular_check(a, b, results[i], MODULAR_CHECK_ROUNDS, seed)) {
+                all_match = false;
+                std::cerr << "Verification failed: Result for " << algorithm_to_string(algorithms[i])
+                          << " fails the modular check.\n";
+            }
+        }
+    }
+    if (mode == VerifyMode::MODULAR) {
+        return all_match;
+    }
+
     for (size_t i = 1; i < results.size(); ++i) {
         if (results[i] != first_result) {
             all_match = false;
@@ -49,11 +85,11 @@ bool verify_results(const std::string& a, const std::string& b,
             long long b_ll = std::stoll(b);
             long long expected = a_ll * b_ll;
             std::string expected_str = std::to_string(expected);
-            if (first_result != expected_str) {
+            if (first_result.str() != expected_str) {
                  all_match = false;
                  std::cerr << "Verification failed: Results do not match built-in multiplication.\n";
                  std::cerr << "  Built-in: " << expected_str << std::endl;
-                 std::cerr << "  Algorithm Result: " << first_result << std::endl;
+                 std::cerr << "  Algorithm Result: " << first_result.str() << std::endl;
             }
         } catch (const std::out_of_range& oor) {
 
@@ -67,7 +103,36 @@ bool verify_results(const std::string& a, const std::string& b,
 }
 
 void print_usage(const char* program_name) {
-    std::cout << "Usage: " << program_name << " [num_tests] [digits_length] [algorithm1] [algorithm2] ...\n\n"
+    std::cout << "Usage: " << program_name << " [--seed N] [--verify MODE] [--perf] [--trace FILE] [--input A B [--output C [--memory BYTES]]] [--stats | --scaling LIST [--weak]] [options] [num_tests] [digits_length] [algorithm1] [algorithm2] ...\n\n"
+              << "  --seed N       - Seed for the random operands (default: random, printed at start)\n"
+              << "  --verify MODE  - cross: compare the algorithms with each other\n"
+              << "                   modular: check each result modulo random 61-bit primes\n"
+              << "                   both: (default)\n"
+              << "  --perf         - Report hardware counters (cycles, instructions, LLC and dTLB\n"
+              << "                   misses, branch misses) per run, summed over all threads;\n"
+              << "                   only in the plain test mode, not with --stats, --scaling or --input\n"
+              << "  --trace FILE   - Write a Chrome trace-event timeline of the parallel tasks to\n"
+              << "                   FILE (requires a build with make TRACE=1)\n"
+              << "  --input A B    - Multiply the decimal numbers in files A and B (memory-mapped)\n"
+              << "                   instead of random operands; checked modulo random primes\n"
+              << "                   (decimal text or .limbs binary files, detected by content)\n"
+              << "  --output C     - With --input: write the product of the first algorithm to C,\n"
+              << "                   as binary limbs if C ends in .limbs, else as decimal text\n"
+              << "  --memory BYTES - With --input and --output: multiply two .limbs files out of\n"
+              << "                   core, in tiles whose working memory stays within BYTES\n"
+              << "                   (suffixes K, M, G allowed); C must end in .limbs\n"
+              << "  --stats        - Repeat each algorithm until the timing is stable and report\n"
+              << "                   median/p10/p90/min per phase (parse, multiply, carry, print)\n"
+              << "  --warmup N     - Untimed runs before measuring (default: 2)\n"
+              << "  --min-reps N   - Minimum measured runs (default: 5)\n"
+              << "  --max-reps N   - Maximum measured runs (default: 100)\n"
+              << "  --target-rse X - Stop once the relative standard error of the total time\n"
+              << "                   is at most X (default: 0.02)\n"
+              << "  --scaling LIST - Rerun each algorithm with every worker count in LIST (e.g. 1,2,4,8),\n"
+              << "                   for both OpenMP and ParlayLib, and report speedup and efficiency;\n"
+              << "                   the stats options control the repetitions\n"
+              << "  --weak         - With --scaling: digits_length is per worker (weak scaling)\n"
+              << "  --format F     - Stats/scaling output: text (default), json or csv\n"
               << "  num_tests      - Number of test cases (default: 5)\n"
               << "  digits_length  - Length of random numbers (default: 1000)\n"
               << "  algorithm(s)   - One or more algorithms to compare (at least one required):\n"
@@ -76,6 +141,8 @@ void print_usage(const char* program_name) {
               << "                   2: karatsuba parallel\n"
               << "                   3: toom cook sequential\n"
               << "                   4: toom cook parallel\n"
+              << "                   5: karatsuba parallel (ParlayLib)\n"
+              << "                   6: toom cook parallel (ParlayLib)\n"
               << "                   (e.g., '4 1 2' to compare Toom Cook Parallel, Karatsuba Seq, Karatsuba Par)\n";
 }
 
@@ -86,125 +153,784 @@ Algorithm parse_algorithm(int choice) {
         case 2: return Algorithm::KARATSUBA_PAR;
         case 3: return Algorithm::TOOM_COOK_SEQ;
         case 4: return Algorithm::TOOM_COOK_PAR;
+        case 5: return Algorithm::KARATSUBA_PAR_PLIB;
+        case 6: return Algorithm::TOOM_COOK_PAR_PLIB;
         default: throw std::invalid_argument("Invalid algorithm choice: " + std::to_string(choice));
     }
 }
 
+// Only the naive kernel accepts lengths that are not powers of two.
+bool needs_power_of_2(Algorithm alg) {
+    return alg != Algorithm::NAIVE;
+}
+
+std::vector<long long> run_kernel(Algorithm alg, const std::vector<long long>& x, const std::vector<long long>& y) {
+    switch (alg) {
+        case Algorithm::NAIVE: return naive_mul_vector(x, y);
+        case Algorithm::KARATSUBA_SEQ: return karatsuba_mul_vector(x, y);
+        case Algorithm::KARATSUBA_PAR: return par_karatsuba_mul_vector(x, y);
+        case Algorithm::TOOM_COOK_SEQ: return toom_cook_mul_vector(x, y);
+        case Algorithm::TOOM_COOK_PAR: return par_toom_cook_mul_vector(x, y);
+        case Algorithm::KARATSUBA_PAR_PLIB: return par_karatsuba_mul_vector_plib(x, y);
+        case Algorithm::TOOM_COOK_PAR_PLIB: return par_toom_cook_mul_vector_plib(x, y);
+        default: return {};
+    }
+}
+
+std::string format_memory(const allocation_stats& m) {
+    auto mib = [](double bytes) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(2) << bytes / (1 << 20) << " MiB";
+        return out.str();
+    };
+    std::string s = "peak " + mib(m.peak_bytes) + ", " + mib(m.total_bytes) + " allocated in " +
+                    std::to_string(m.allocations) + " allocations";
+    if (m.parlay_pool_bytes != 0) {
+        s += ", parlay pool " + mib(m.parlay_pool_bytes);
+    }
+    return s;
+}
+
+std::string format_perf(const perf_sample& p) {
+    auto count = [](const char* name, long long v) {
+        return std::string(name) + " " + (v < 0 ? "n/a" : std::to_string(v));
+    };
+    std::ostringstream ipc;
+    ipc << std::fixed << std::setprecision(2) << p.ipc();
+    return count("cycles", p.cycles) + ", " + count("instructions", p.instructions) +
+           " (IPC " + (p.ipc() < 0 ? "n/a" : ipc.str()) + "), " + count("LLC misses", p.llc_misses) + ", " +
+           count("dTLB misses", p.dtlb_misses) + ", " + count("branch misses", p.branch_misses) + ", " +
+           count("task clock ns", p.task_clock_ns);
+}
+
+enum class OutputFormat {
+    TEXT,
+    JSON,
+    CSV,
+};
+
+struct StatsOptions {
+    bool enabled = false;
+    size_t warmup = 2;
+    size_t min_reps = 5;
+    size_t max_reps = 100;
+    double target_rse = 0.02;
+    OutputFormat format = OutputFormat::TEXT;
+};
+
+static const char* PHASE_NAMES[] = {"parse", "multiply", "carry", "print", "total"};
+static constexpr size_t NUM_PHASES = 5;
+
+// Times one full multiplication split into its phases: parsing both decimal
+// strings into digit vectors, the kernel, carrying the raw coefficients into
+// digits, and rendering the decimal string. Returns the product digits.
+std::vector<long long> time_phases(Algorithm alg, const std::string& a, const std::string& b,
+                                   std::array<double, NUM_PHASES>& phases) {
+    using clock = std::chrono::steady_clock;
+    auto seconds = [](clock::time_point from, clock::time_point to) {
+        return std::chrono::duration<double>(to - from).count();
+    };
+
+    auto t0 = clock::now();
+    auto x = string_to_vector(a, needs_power_of_2(alg));
+    auto y = string_to_vector(b, needs_power_of_2(alg));
+    auto t1 = clock::now();
+    auto coefficients = run_kernel(alg, x, y);
+    auto t2 = clock::now();
+    normalize_vector(coefficients);
+    auto t3 = clock::now();
+    std::string rendered(coefficients.size(), '0');
+    for (size_t i = 0; i < coefficients.size(); ++i) {
+        rendered[coefficients.size() - 1 - i] = char('0' + coefficients[i]);
+    }
+    auto t4 = clock::now();
+
+    phases = {seconds(t0, t1), seconds(t1, t2), seconds(t2, t3), seconds(t3, t4), seconds(t0, t4)};
+    return coefficients;
+}
+
+struct StatsRecord {
+    size_t test;
+    Algorithm algorithm;
+    size_t reps;
+    bool converged;
+    bool verified;
+    std::array<timing_summary, NUM_PHASES> phases;
+    allocation_stats memory;  // of the first measured run
+};
+
+// After the warmup runs, repeats alg until the relative standard error of the
+// total time drops below the target (or max_reps is reached).
+StatsRecord measure_algorithm(size_t test, Algorithm alg, const std::string& A, const std::string& B,
+                              const StatsOptions& opts, size_t seed) {
+    std::array<double, NUM_PHASES> phases;
+    std::vector<long long> product;
+    for (size_t w = 0; w < opts.warmup; ++w) {
+        product = time_phases(alg, A, B, phases);
+    }
+
+    std::array<std::vector<double>, NUM_PHASES> samples;
+    bool converged = false;
+    allocation_stats memory;
+    while (samples[0].size() < opts.max_reps) {
+        if (samples[0].empty()) {
+            product.clear();
+            product.shrink_to_fit();
+            allocation_stats_reset();
+        }
+        product = time_phases(alg, A, B, phases);
+        if (samples[0].empty()) {
+            memory = allocation_stats_read();
+        }
+        for (size_t p = 0; p < NUM_PHASES; ++p) {
+            samples[p].push_back(phases[p]);
+        }
+        if (samples[0].size() >= opts.min_reps &&
+            summarize_times(samples[NUM_PHASES - 1]).rse <= opts.target_rse) {
+            converged = true;
+            break;
+        }
+    }
+
+    StatsRecord rec{test, alg, samples[0].size(), converged,
+                    modular_check(A, B, decimal_view(std::move(product)), MODULAR_CHECK_ROUNDS, seed), {}, memory};
+    for (size_t p = 0; p < NUM_PHASES; ++p) {
+        rec.phases[p] = summarize_times(samples[p]);
+    }
+    return rec;
+}
+
+// Measures every algorithm on num_tests operand pairs and reports per-phase
+// statistics.
+int run_stats(const StatsOptions& opts, size_t num_tests, size_t length, size_t seed,
+              const std::vector<Algorithm>& algorithms) {
+    parlay::random_generator operand_seeds(seed);
+    std::vector<StatsRecord> records;
+    bool all_passed = true;
+
+    for (size_t t = 1; t <= num_tests; ++t) {
+        auto A = random_bigint(length, operand_seeds[2 * t]());
+        auto B = random_bigint(length, operand_seeds[2 * t + 1]());
+
+        for (Algorithm alg : algorithms) {
+            StatsRecord rec = measure_algorithm(t, alg, A, B, opts, seed);
+            all_passed &= rec.verified;
+            records.push_back(rec);
+        }
+    }
+
+    std::cout << std::setprecision(9);
+    switch (opts.format) {
+        case OutputFormat::JSON:
+            std::cout << "{\n  \"seed\": " << seed << ",\n  \"digits\": " << length
+                      << ",\n  \"omp_threads\": " << omp_get_max_threads() << ",\n  \"results\": [";
+            for (size_t r = 0; r < records.size(); ++r) {
+                const auto& rec = records[r];
+                std::cout << (r ? "," : "") << "\n    {\"test\": " << rec.test
+                          << ", \"algorithm\": \"" << algorithm_to_string(rec.algorithm) << "\""
+                          << ", \"reps\": " << rec.reps
+                          << ", \"converged\": " << (rec.converged ? "true" : "false")
+                          << ", \"verified\": " << (rec.verified ? "true" : "false")
+                          << ", \"peak_bytes\": " << rec.memory.peak_bytes
+                          << ", \"allocated_bytes\": " << rec.memory.total_bytes
+                          << ", \"allocations\": " << rec.memory.allocations
+                          << ", \"parlay_pool_bytes\": " << rec.memory.parlay_pool_bytes
+                          << ", \"phases\": {";
+                for (size_t p = 0; p < NUM_PHASES; ++p) {
+                    const auto& s = rec.phases[p];
+                    std::cout << (p ? ", " : "") << "\"" << PHASE_NAMES[p] << "\": {"
+                              << "\"mean\": " << s.mean << ", \"stddev\": " << s.stddev
+                              << ", \"rse\": " << s.rse << ", \"min\": " << s.min
+                              << ", \"p10\": " << s.p10 << ", \"median\": " << s.median
+                              << ", \"p90\": " << s.p90 << "}";
+                }
+                std::cout << "}}";
+            }
+            std::cout << "\n  ]\n}\n";
+            break;
+        case OutputFormat::CSV:
+            std::cout << "test,algorithm,digits,reps,converged,verified,peak_bytes,allocated_bytes,allocations,phase,mean,stddev,rse,min,p10,median,p90\n";
+            for (const auto& rec : records) {
+                for (size_t p = 0; p < NUM_PHASES; ++p) {
+                    const auto& s = rec.phases[p];
+                    std::cout << rec.test << "," << algorithm_to_string(rec.algorithm) << "," << length << ","
+                              << rec.reps << "," << rec.converged << "," << rec.verified << ","
+                              << rec.memory.peak_bytes << "," << rec.memory.total_bytes << ","
+                              << rec.memory.allocations << ","
+                              << PHASE_NAMES[p] << "," << s.mean << "," << s.stddev << "," << s.rse << ","
+                              << s.min << "," << s.p10 << "," << s.median << "," << s.p90 << "\n";
+                }
+            }
+            break;
+        case OutputFormat::TEXT:
+            for (const auto& rec : records) {
+                std::cout << "Test #" << rec.test << " " << algorithm_to_string(rec.algorithm) << ": "
+                          << rec.reps << " reps" << (rec.converged ? "" : " (RSE target not reached)")
+                          << ", verification " << (rec.verified ? "PASSED" : "FAILED") << "\n";
+                std::cout << "  memory: " << format_memory(rec.memory) << "\n";
+                std::cout << "  " << std::left << std::setw(10) << "phase" << std::right
+                          << std::setw(14) << "median (s)" << std::setw(14) << "p10" << std::setw(14) << "p90"
+                          << std::setw(14) << "min" << std::setw(10) << "rse" << "\n";
+                for (size_t p = 0; p < NUM_PHASES; ++p) {
+                    const auto& s = rec.phases[p];
+                    std::cout << "  " << std::left << std::setw(10) << PHASE_NAMES[p] << std::right << std::fixed
+                              << std::setprecision(6) << std::setw(14) << s.median << std::setw(14) << s.p10
+                              << std::setw(14) << s.p90 << std::setw(14) << s.min
+                              << std::setprecision(4) << std::setw(10) << s.rse << "\n";
+                }
+                std::cout << std::defaultfloat;
+            }
+            break;
+    }
+
+    return all_passed ? 0 : 1;
+}
+
+// Runs f with p workers in both runtimes: an OpenMP team of p threads for
+// the OpenMP kernels and a private p-worker parlay scheduler for the
+// ParlayLib ones.
+template <typename F>
+void with_workers(size_t p, F&& f) {
+    int saved = omp_get_max_threads();
+    omp_set_num_threads(static_cast<int>(p));
+    parlay::execute_with_scheduler(static_cast<unsigned int>(p), std::forward<F>(f));
+    omp_set_num_threads(saved);
+}
+
+// Exponent of the algorithm's operation count, used to compare weak-scaling
+// runs whose work grows faster than their size.
+double work_exponent(Algorithm alg) {
+    switch (alg) {
+        case Algorithm::NAIVE: return 2.0;
+        case Algorithm::KARATSUBA_SEQ:
+        case Algorithm::KARATSUBA_PAR:
+        case Algorithm::KARATSUBA_PAR_PLIB: return std::log2(3.0);
+        default: return std::log(5.0) / std::log(3.0);
+    }
+}
+
+// Reruns each algorithm for every worker count. Strong scaling keeps the
+// operand length fixed; weak scaling multiplies it by the worker count.
+// Speedup and efficiency are relative to the first (smallest) worker count
+// and use the median multiply-phase time.
+int run_scaling(const StatsOptions& opts, const std::vector<size_t>& workers, bool weak,
+                size_t length, size_t seed, const std::vector<Algorithm>& algorithms) {
+    struct Row {
+        Algorithm algorithm;
+        size_t workers;
+        size_t digits;
+        double time;
+        double speedup;
+        double efficiency;
+        double work_efficiency;
+        bool verified;
+    };
+    std::vector<Row> rows;
+    bool all_passed = true;
+
+    parlay::random_generator operand_seeds(seed);
+    std::vector<std::pair<std::string, std::string>> operands(workers.size());
+    for (size_t i = 0; i < workers.size(); ++i) {
+        if (weak || i == 0) {
+            size_t digits = weak ? length * workers[i] : length;
+            operands[i] = {random_bigint(digits, operand_seeds[2]()), random_bigint(digits, operand_seeds[3]())};
+        } else {
+            operands[i] = operands[0];
+        }
+    }
+
+    for (Algorithm alg : algorithms) {
+        double base_time = 0;
+        for (size_t i = 0; i < workers.size(); ++i) {
+            const auto& [A, B] = operands[i];
+            StatsRecord rec;
+            with_workers(workers[i], [&]() { rec = measure_algorithm(1, alg, A, B, opts, seed); });
+
+            double time = rec.phases[1].median;
+            if (i == 0) {
+                base_time = time;
+            }
+            double p_ratio = double(workers[i]) / workers[0];
+            double size_ratio = double(A.size()) / operands[0].first.size();
+
+            Row row{alg, workers[i], A.size(), time, 0, 0, 0, rec.verified};
+            if (weak) {
+                // Ideal weak scaling keeps the time constant.
+                row.efficiency = base_time / time;
+                row.speedup = row.efficiency * p_ratio;
+                row.work_efficiency = row.efficiency * std::pow(size_ratio, work_exponent(alg)) / p_ratio;
+            } else {
+                row.speedup = base_time / time;
+                row.efficiency = row.speedup / p_ratio;
+                row.work_efficiency = row.efficiency;
+            }
+            all_passed &= rec.verified;
+            rows.push_back(row);
+        }
+    }
+
+    const char* mode = weak ? "weak" : "strong";
+    switch (opts.format) {
+        case OutputFormat::JSON:
+            std::cout << std::setprecision(9) << "{\n  \"seed\": " << seed << ",\n  \"mode\": \"" << mode
+                      << "\",\n  \"results\": [";
+            for (size_t r = 0; r < rows.size(); ++r) {
+                const auto& row = rows[r];
+                std::cout << (r ? "," : "") << "\n    {\"algorithm\": \"" << algorithm_to_string(row.algorithm)
+                          << "\", \"workers\": " << row.workers << ", \"digits\": " << row.digits
+                          << ", \"median_seconds\": " << row.time << ", \"speedup\": " << row.speedup
+                          << ", \"efficiency\": " << row.efficiency
+                          << ", \"work_efficiency\": " << row.work_efficiency
+                          << ", \"verified\": " << (row.verified ? "true" : "false") << "}";
+            }
+            std::cout << "\n  ]\n}\n";
+            break;
+        case OutputFormat::CSV:
+            std::cout << std::setprecision(9)
+                      << "mode,algorithm,workers,digits,median_seconds,speedup,efficiency,work_efficiency,verified\n";
+            for (const auto& row : rows) {
+                std::cout << mode << "," << algorithm_to_string(row.algorithm) << "," << row.workers << ","
+                          << row.digits << "," << row.time << "," << row.speedup << "," << row.efficiency << ","
+                          << row.work_efficiency << "," << row.verified << "\n";
+            }
+            break;
+        case OutputFormat::TEXT:
+            std::cout << (weak ? "Weak" : "Strong") << " scaling, "
+                      << (weak ? std::to_string(length) + " digits per worker" : std::to_string(length) + " digits")
+                      << " (median multiply time):\n";
+            for (size_t r = 0; r < rows.size(); ++r) {
+                const auto& row = rows[r];
+                if (r == 0 || rows[r - 1].algorithm != row.algorithm) {
+                    std::cout << "\n" << algorithm_to_string(row.algorithm) << "\n"
+                              << std::setw(8) << "workers" << std::setw(12) << "digits" << std::setw(14) << "time (s)"
+                              << std::setw(10) << "speedup" << std::setw(12) << "efficiency";
+                    if (weak) {
+                        std::cout << std::setw(14) << "work-adjusted";
+                    }
+                    std::cout << "\n";
+                }
+                std::cout << std::fixed << std::setw(8) << row.workers << std::setw(12) << row.digits
+                          << std::setprecision(6) << std::setw(14) << row.time << std::setprecision(2)
+                          << std::setw(10) << row.speedup << std::setw(12) << row.efficiency;
+                if (weak) {
+                    std::cout << std::setw(14) << row.work_efficiency;
+                }
+                std::cout << (row.verified ? "" : "  VERIFICATION FAILED") << "\n" << std::defaultfloat;
+            }
+            break;
+    }
+
+    return all_passed ? 0 : 1;
+}
+
+// Parses a comma-separated list of worker counts such as "1,2,4,8".
+std::vector<size_t> parse_worker_list(const std::string& list) {
+    std::vector<size_t> workers;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        size_t p = std::stoul(list.substr(start, end - start));
+        if (p == 0) {
+            throw std::invalid_argument("worker counts must be positive");
+        }
+        workers.push_back(p);
+        start = end + 1;
+    }
+    std::sort(workers.begin(), workers.end());
+    return workers;
+}
+
+// An operand file in either format, told apart by the limb file magic. Both
+// stay mapped; digits() is the only copy made.
+struct operand_file {
+    std::unique_ptr<decimal_file> text;
+    std::unique_ptr<limb_file> limbs;
+
+    explicit operand_file(const std::string& path) {
+        if (!limb_file::matches(path)) {
+            text = std::make_unique<decimal_file>(path);
+            return;
+        }
+        limbs = std::make_unique<limb_file>(path);
+        if (limbs->base() != 10 || limbs->negative()) {
+            throw std::runtime_error(path + ": only non-negative base-10 limb files can be multiplied");
+        }
+        if (!limbs->verify()) {
+            throw std::runtime_error(path + ": checksum mismatch");
+        }
+        // The kernels take digits; carried files are the norm, but a file of
+        // raw coefficients would overflow them.
+        const long long* d = limbs->data();
+        if (std::any_of(d, d + limbs->size(), [](long long v) { return v < 0 || v > 9; })) {
+            throw std::runtime_error(path + ": limbs are not carried to decimal digits");
+        }
+    }
+
+    const char* format() const { return text ? "text" : "limbs"; }
+    size_t size() const { return text ? text->size() : limbs->size(); }
+    std::vector<long long> digits(size_t length) const {
+        return text ? text->digits(length) : limbs->to_vector(length);
+    }
+};
+
+static bool ends_with(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// "512M" and the like: a byte count with an optional K, M or G (powers of
+// 1024).
+static size_t parse_bytes(const std::string& text) {
+    size_t end = 0;
+    size_t value = std::stoull(text, &end);
+    std::string suffix = text.substr(end);
+    if (suffix == "K" || suffix == "k") return value << 10;
+    if (suffix == "M" || suffix == "m") return value << 20;
+    if (suffix == "G" || suffix == "g") return value << 30;
+    if (!suffix.empty()) throw std::invalid_argument("bad byte count " + text);
+    return value;
+}
+
+// Out-of-core product of two limb files; see multiply_limb_files.
+int run_out_of_core(const std::string& path_a, const std::string& path_b, const std::string& output_path,
+                    size_t memory_budget) {
+    try {
+        auto start = std::chrono::steady_clock::now();
+        out_of_core_stats stats = multiply_limb_files(path_a, path_b, output_path, memory_budget);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Out-of-core product of " << path_a << " and " << path_b << " -> " << output_path << "\n"
+                  << "  Tile: " << stats.tile_digits << " digits, working memory " << stats.working_bytes
+                  << " bytes (budget " << memory_budget << ")\n"
+                  << "  Tile products: " << stats.tile_products << ", read " << stats.bytes_read << " bytes, wrote "
+                  << stats.bytes_written << " bytes\n"
+                  << "  Product: " << stats.product_digits << " digits in " << std::fixed << std::setprecision(6)
+                  << seconds << " seconds\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Multiplies two operands read from files. Only the mapped inputs, one digit
+// vector per operand and the kernel's output are resident; the product is
+// carried in place and written without building a string.
+int run_files(const std::string& path_a, const std::string& path_b, const std::string& output_path,
+              size_t seed, const std::vector<Algorithm>& algorithms) {
+    using clock = std::chrono::steady_clock;
+    auto since = [](clock::time_point start) {
+        return std::chrono::duration<double>(clock::now() - start).count();
+    };
+
+    try {
+        auto start = clock::now();
+        operand_file file_a(path_a);
+        operand_file file_b(path_b);
+        std::cout << "A: " << path_a << " (" << file_a.size() << " digits, " << file_a.format() << ")\n"
+                  << "B: " << path_b << " (" << file_b.size() << " digits, " << file_b.format() << ")\n"
+                  << "  Map and validate: " << std::fixed << std::setprecision(6) << since(start) << " seconds\n";
+
+        bool all_passed = true;
+        for (size_t i = 0; i < algorithms.size(); ++i) {
+            Algorithm alg = algorithms[i];
+            size_t len = std::max(file_a.size(), file_b.size());
+            if (needs_power_of_2(alg)) {
+                size_t p = 1;
+                while (p < len) p <<= 1;
+                len = p;
+            }
+
+            std::cout << algorithm_to_string(alg) << ":\n";
+            start = clock::now();
+            std::vector<long long> x = file_a.digits(len);
+            std::vector<long long> y = file_b.digits(len);
+            std::cout << "  Parse: " << since(start) << " seconds\n";
+
+            allocation_stats_reset();
+            start = clock::now();
+            std::vector<long long> product = run_kernel(alg, x, y);
+            std::cout << "  Multiply: " << since(start) << " seconds\n";
+            std::cout << "  Memory: " << format_memory(allocation_stats_read()) << "\n";
+
+            bool passed = modular_check(x, y, product, MODULAR_CHECK_ROUNDS, seed);
+            all_passed &= passed;
+            std::cout << "  Verification: " << (passed ? "PASSED" : "FAILED") << "\n";
+
+            if (i == 0 && !output_path.empty()) {
+                x = {};
+                y = {};
+                start = clock::now();
+                normalize_vector(product);
+                if (ends_with(output_path, ".limbs")) {
+                    write_limb_file(output_path, product);
+                } else {
+                    write_decimal_file(output_path, product);
+                }
+                std::cout << "  Carry and write " << output_path << " (" << product.size()
+                          << " digits): " << since(start) << " seconds\n";
+            }
+        }
+        std::cout << "All tests " << (all_passed ? "PASSED" : "FAILED") << "\n";
+        return all_passed ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
 int main(int argc, char* argv[]) {
     size_t num_tests = 5;
     size_t length = 1000;
     std::vector<Algorithm> algorithms;
-
-    int arg_idx = 1;
-
-    if (arg_idx < argc) {
-        if (std::string(argv[arg_idx]) == "-h" || std::string(argv[arg_idx]) == "--help") {
+    size_t seed = std::random_device{}();
+    VerifyMode verify_mode = VerifyMode::BOTH;
+    StatsOptions stats;
+    std::vector<size_t> scaling_workers;
+    bool weak_scaling = false;
+    bool use_perf = false;
+    std::string trace_path;
+    std::vector<std::string> input_paths;
+    std::string output_path;
+    size_t memory_budget = 0;
+
+    // Flags may appear anywhere; what remains is parsed positionally.
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
             print_usage(argv[0]);
             return 0;
         }
         try {
-            num_tests = std::stoul(argv[arg_idx]);
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) {
+                    throw std::invalid_argument(arg + " requires a value");
+                }
+                return argv[++i];
+            };
+
+            if (arg == "--seed") {
+                seed = std::stoull(value());
+            } else if (arg == "--verify") {
+                std::string mode = value();
+                if (mode == "cross") {
+                    verify_mode = VerifyMode::CROSS;
+                } else if (mode == "modular") {
+                    verify_mode = VerifyMode::MODULAR;
+                } else if (mode == "both") {
+                    verify_mode = VerifyMode::BOTH;
+                } else {
+                    throw std::invalid_argument("--verify expects cross, modular or both");
+                }
+            } else if (arg == "--perf") {
+                use_perf = true;
+            } else if (arg == "--trace") {
+                trace_path = value();
+#ifndef BIGINT_TRACE
+                throw std::invalid_argument("tracing is not compiled in; rebuild with make clean && make TRACE=1");
+#endif
+            } else if (arg == "--input") {
+                input_paths = {value(), value()};
+            } else if (arg == "--output") {
+                output_path = value();
+            } else if (arg == "--memory") {
+                memory_budget = parse_bytes(value());
+            } else if (arg == "--stats") {
+                stats.enabled = true;
+            } else if (arg == "--warmup") {
+                stats.warmup = std::stoul(value());
+            } else if (arg == "--min-reps") {
+                stats.min_reps = std::max<size_t>(2, std::stoul(value()));
+            } else if (arg == "--max-reps") {
+                stats.max_reps = std::stoul(value());
+            } else if (arg == "--target-rse") {
+                stats.target_rse = std::stod(value());
+            } else if (arg == "--scaling") {
+                scaling_workers = parse_worker_list(value());
+            } else if (arg == "--weak") {
+                weak_scaling = true;
+            } else if (arg == "--format") {
+                std::string format = value();
+                if (format == "text") {
+                    stats.format = OutputFormat::TEXT;
+                } else if (format == "json") {
+                    stats.format = OutputFormat::JSON;
+                } else if (format == "csv") {
+                    stats.format = OutputFormat::CSV;
+                } else {
+                    throw std::invalid_argument("--format expects text, json or csv");
+                }
+            } else {
+                args.push_back(arg);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error: invalid option " << arg << " (" << e.what() << ").\n";
+            return 1;
+        }
+    }
+
+    // With --input every positional argument is an algorithm.
+    size_t arg_idx = 0;
+
+    if (input_paths.empty() && arg_idx < args.size()) {
+        try {
+            num_tests = std::stoul(args[arg_idx]);
             arg_idx++;
         } catch (...) {
 
         }
     }
 
-    if (arg_idx < argc) {
+    if (input_paths.empty() && arg_idx < args.size()) {
          try {
-            length = std::stoul(argv[arg_idx]);
+            length = std::stoul(args[arg_idx]);
             arg_idx++;
         } catch (...) {
 
         }
     }
 
-    while (arg_idx < argc) {
+    while (arg_idx < args.size()) {
         try {
-            algorithms.push_back(parse_algorithm(std::stoi(argv[arg_idx])));
+            algorithms.push_back(parse_algorithm(std::stoi(args[arg_idx])));
             arg_idx++;
         } catch (const std::invalid_argument& e) {
             std::cerr << "Error: " << e.what() << ". Stopping argument parsing.\n";
             break; // Stop parsing if an invalid algorithm is found
         } catch (...) {
-             std::cerr << "Error parsing argument " << argv[arg_idx] << ". Stopping argument parsing.\n";
+             std::cerr << "Error parsing argument " << args[arg_idx] << ". Stopping argument parsing.\n";
              break;
         }
     }
 
+    // Counters are only read around the runs of the plain test loop.
+    if (use_perf && (stats.enabled || !scaling_workers.empty() || !input_paths.empty())) {
+        std::cerr << "Error: --perf cannot be combined with --stats, --scaling or --input.\n";
+        return 1;
+    }
+    if (memory_budget != 0) {
+        if (input_paths.empty() || !ends_with(output_path, ".limbs")) {
+            std::cerr << "Error: --memory requires --input and an --output ending in .limbs.\n";
+            return 1;
+        }
+        return run_out_of_core(input_paths[0], input_paths[1], output_path, memory_budget);
+    }
+    if (!input_paths.empty()) {
+        if (algorithms.empty()) {
+            algorithms.push_back(Algorithm::TOOM_COOK_PAR_PLIB);
+        }
+        return run_files(input_paths[0], input_paths[1], output_path, seed, algorithms);
+    }
+    if (!output_path.empty()) {
+        std::cerr << "Error: --output requires --input.\n";
+        return 1;
+    }
+
     if (algorithms.empty()) {
-        std::cout << "No algorithms specified, defaulting to Naive and Karatsuba Parallel.\n";
+        // Keep machine-readable stats output clean.
+        (stats.format == OutputFormat::TEXT ? std::cout : std::cerr)
+            << "No algorithms specified, defaulting to Naive and Karatsuba Parallel.\n";
         algorithms.push_back(Algorithm::NAIVE);
         algorithms.push_back(Algorithm::KARATSUBA_PAR);
     }
 
+    if (!scaling_workers.empty()) {
+        return run_scaling(stats, scaling_workers, weak_scaling, length, seed, algorithms);
+    }
+    if (stats.enabled) {
+        return run_stats(stats, num_tests, length, seed, algorithms);
+    }
+
     std::cout << "Running " << num_tests << " tests with " << length
               << "-digit operands comparing:";
     for (size_t i = 0; i < algorithms.size(); ++i) {
         std::cout << " " << algorithm_to_string(algorithms[i]) << (i == algorithms.size() - 1 ? "" : ",");
     }
-    std::cout << ".\n\n";
+    std::cout << ".\n";
+    std::cout << "Seed: " << seed << " (rerun with --seed " << seed << " to reproduce)\n\n";
+
+    // Operands of test t come from streams 2t and 2t+1 of the seed, so any
+    // single test can be regenerated independently of the others.
+    parlay::random_generator operand_seeds(seed);
+
+    // Counters the kernel refuses (no PMU in a VM, perf_event_paranoid,
+    // seccomp) are reported as n/a; the run itself is unaffected.
+    perf_counters perf;
+    if (use_perf) {
+        perf.start();
+        perf_sample probe = perf.stop();
+        if (!perf.error().empty()) {
+            std::cout << "Note: some performance counters are unavailable (" << perf.error() << ").\n";
+        }
+        if (probe.cycles < 0 && probe.task_clock_ns < 0) {
+            std::cout << "Note: no performance counters available; continuing without them.\n\n";
+            use_perf = false;
+        }
+    }
 
     std::vector<double> total_times(algorithms.size(), 0.0);
     bool all_tests_passed = true;
+    trace_reset();
 
     for (size_t t = 1; t <= num_tests; ++t) {
         std::cout << "Test #" << t << ":\n";
 
-        auto A = random_bigint(length);
-        auto B = random_bigint(length);
+        auto A = random_bigint(length, operand_seeds[2 * t]());
+        auto B = random_bigint(length, operand_seeds[2 * t + 1]());
 
         std::cout << "  A (" << A.size() << " digits) = "
                   << truncate_display(A) << "\n";
         std::cout << "  B (" << B.size() << " digits) = "
                   << truncate_display(B) << "\n";
 
-        std::vector<std::string> results;
+        std::vector<decimal_view> results;
         std::vector<double> times;
-
-        auto run_single_algorithm = [&](Algorithm alg) -> std::pair<std::string, double> {
-            std::string result;
+        allocation_stats memory;
+        perf_sample counters;
+
+        // Results stay as coefficient vectors; only the digits that are
+        // displayed get carried out, never the whole decimal string.
+        auto run_single_algorithm = [&](Algorithm alg) -> std::pair<decimal_view, double> {
+            std::vector<long long> result;
+            profile_reset();
+            trace_process("Test #" + std::to_string(t) + ": " + algorithm_to_string(alg));
+            allocation_stats_reset();
+            if (use_perf) {
+                perf.start();
+            }
             auto start = std::chrono::high_resolution_clock::now();
 
-            switch (alg) {
-                case Algorithm::NAIVE:
-                    result = naive_mul_string(A, B);
-                    break;
-                case Algorithm::KARATSUBA_SEQ:
-                    result = karatsuba_mul_string(A, B);
-                    break;
-                case Algorithm::KARATSUBA_PAR:
-                    result = par_karatsuba_mul_string(A, B);
-                    break;
-                case Algorithm::TOOM_COOK_SEQ:
-                    result = toom_cook_mul_string(A, B);
-                    break;
-                case Algorithm::TOOM_COOK_PAR:
-                    result = par_toom_cook_mul_string(A, B);
-                    // result = par_toom_cook_mul_string_plib(A, B);
-                    break;
-                default:
-                    result = "Error: Unknown Algorithm";
-                    break;
-            }
+            bool pad = needs_power_of_2(alg);
+            BIGINT_TRACE_SPAN("multiply", result = run_kernel(alg, string_to_vector(A, pad), string_to_vector(B, pad)));
 
             auto end = std::chrono::high_resolution_clock::now();
+            memory = allocation_stats_read();
+            if (use_perf) {
+                counters = perf.stop();
+            }
             double elapsed_time = std::chrono::duration<double>(end - start).count();
-            return {result, elapsed_time};
+            return {decimal_view(std::move(result)), elapsed_time};
         };
 
         for (size_t i = 0; i < algorithms.size(); ++i) {
             auto [result, time] = run_single_algorithm(algorithms[i]);
-            results.push_back(result);
+            std::cout << "  " << algorithm_to_string(algorithms[i]) << " result (" << result.size() << " digits) = "
+                      << result.truncated() << "\n";
+
+            results.push_back(std::move(result));
             times.push_back(time);
             total_times[i] += time;
-
-            std::cout << "  " << algorithm_to_string(algorithms[i]) << " result (" << result.size() << " digits) = "
-                      << truncate_display(result) << "\n";
             std::cout << "  Time: " << std::fixed << std::setprecision(6) << time << " seconds\n";
+            std::cout << "  Memory: " << format_memory(memory) << "\n";
+            if (use_perf) {
+                std::cout << "  Counters: " << format_perf(counters) << "\n";
+            }
+            profile_report(std::cout);
         }
 
-        bool passed = verify_results(A, B, results, algorithms);
+        bool passed = verify_results(A, B, results, algorithms, verify_mode, operand_seeds[2 * t]() ^ seed);
         all_tests_passed &= passed;
         std::cout << "  Verification: " << (passed ? "PASSED" : "FAILED") << "\n";
 
@@ -241,5 +967,15 @@ int main(int argc, char* argv[]) {
 
     std::cout << "All tests " << (all_tests_passed ? "PASSED" : "FAILED") << "\n";
 
+    if (!trace_path.empty()) {
+        std::ofstream trace_file(trace_path);
+        trace_write(trace_file);
+        if (!trace_file) {
+            std::cerr << "Error: could not write trace to " << trace_path << ".\n";
+            return 1;
+        }
+        std::cout << "Trace written to " << trace_path << " (open in chrome://tracing or ui.perfetto.dev)\n";
+    }
+
     return 0;
 }
@@ -0,0 +1,119 @@
+// Protocol checks for multiply_server.
+//
+//   ./test_server [SERVER]    (default: ./multiply_server)
+//
+// Starts the server on a temporary socket and sends it hand-built records:
+// uncarried limbs, which must be carried before multiplying, and limbs out of
+// range, which must be answered with an error frame and counted as failed.
+// Exits non-zero on the first reply that differs from the expected one.
+
+#include "bigint_multiply.h"
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "multiply_protocol.h"
+
+using BigInt = std::vector<long long>;
+
+static int connect_to(const std::string& path) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    // The server needs a moment to start listening.
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+            return fd;
+        }
+        if (fd >= 0) close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    throw std::runtime_error(path + ": server did not start");
+}
+
+// Sends x * y as raw records and returns the reply type, with the product or
+// the reply text.
+static frame_type request(int fd, uint64_t id, const BigInt& x, const BigInt& y, BigInt& product, std::string& text) {
+    frame_header header = {FRAME_MAGIC, static_cast<uint32_t>(frame_type::multiply), id,
+                           limb_record_bytes(x.size()) + limb_record_bytes(y.size())};
+    send_all(fd, &header, sizeof(header));
+    send_limb_record(fd, x, false);
+    send_limb_record(fd, y, false);
+
+    frame_header reply;
+    if (!recv_all(fd, &reply, sizeof(reply)) || reply.magic != FRAME_MAGIC || reply.id != id) {
+        throw std::runtime_error("malformed reply to request " + std::to_string(id));
+    }
+    if (reply.type == static_cast<uint32_t>(frame_type::product)) {
+        size_t available = reply.length;
+        bool negative = false;
+        product = recv_limb_record(fd, available, negative);
+        discard(fd, available);
+    } else {
+        text.assign(reply.length, '\0');
+        recv_all(fd, &text[0], text.size());
+    }
+    return static_cast<frame_type>(reply.type);
+}
+
+int main(int argc, char* argv[]) {
+    std::string server = argc > 1 ? argv[1] : "./multiply_server";
+    std::string socket_path = "/tmp/test_server." + std::to_string(getpid()) + ".sock";
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        execl(server.c_str(), server.c_str(), socket_path.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+
+    int failures = 0;
+    auto check = [&](bool ok, const std::string& what) {
+        std::cout << (ok ? "PASS " : "FAIL ") << what << "\n";
+        failures += !ok;
+    };
+
+    try {
+        int fd = connect_to(socket_path);
+        BigInt product;
+        std::string text;
+        uint64_t id = 0;
+
+        frame_type type = request(fd, ++id, {13}, {4}, product, text);
+        check(type == frame_type::product && product == BigInt({2, 5}), "uncarried [13] x [4] = 52");
+
+        BigInt expected(37, 0);
+        expected[36] = 1;
+        type = request(fd, ++id, {1000000000000000000LL}, {1000000000000000000LL}, product, text);
+        check(type == frame_type::product && product == expected, "[10^18] x [10^18] = 10^36");
+
+        type = request(fd, ++id, {-3}, {4}, product, text);
+        check(type == frame_type::error, "negative limb rejected: " + text);
+
+        type = request(fd, ++id, {LLONG_MAX}, {1}, product, text);
+        check(type == frame_type::error, "oversized limb rejected: " + text);
+
+        type = request(fd, ++id, {2}, {3}, product, text);
+        check(type == frame_type::product && product == BigInt({6}), "connection usable after errors");
+
+        multiply_client client(socket_path);
+        std::string stats = client.stats();
+        check(stats.find("\"failed\":2") != std::string::npos, "two requests counted failed: " + stats);
+        close(fd);
+    } catch (const std::exception& e) {
+        check(false, e.what());
+    }
+
+    kill(pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,44 @@
+#include "bigint_multiply.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+// p-th percentile (0 <= p <= 1) of sorted samples, interpolating linearly
+// between the two nearest ranks.
+static double percentile(const std::vector<double>& sorted, double p) {
+    double rank = p * (sorted.size() - 1);
+    size_t lo = static_cast<size_t>(rank);
+    size_t hi = std::min(lo + 1, sorted.size() - 1);
+    return sorted[lo] + (rank - lo) * (sorted[hi] - sorted[lo]);
+}
+
+timing_summary summarize_times(std::vector<double> samples) {
+    timing_summary s;
+    s.count = samples.size();
+    if (samples.empty()) {
+        return s;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (double x : samples) {
+        sum += x;
+    }
+    s.mean = sum / s.count;
+
+    if (s.count > 1) {
+        double sq = 0;
+        for (double x : samples) {
+            sq += (x - s.mean) * (x - s.mean);
+        }
+        s.stddev = std::sqrt(sq / (s.count - 1));
+    }
+    // Standard error of the mean relative to the mean.
+    s.rse = s.mean > 0 ? s.stddev / std::sqrt(double(s.count)) / s.mean : 0;
+
+    s.min = samples.front();
+    s.p10 = percentile(samples, 0.10);
+    s.median = percentile(samples, 0.50);
+    s.p90 = percentile(samples, 0.90);
+    return s;
+}
@@ -0,0 +1,132 @@
+#include "bigint_trace.h"
+#include <vector>
+#include <string>
+#include <iomanip>
+
+#ifdef BIGINT_TRACE
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+
+#include "parlaylib/include/parlay/thread_specific.h"
+
+struct trace_event {
+    const char* name;
+    uint32_t process;
+    uint32_t worker;
+    uint32_t spawner;
+    double spawned;
+    double begin;
+    double end;
+};
+
+using trace_buffer = std::vector<trace_event>;
+
+static parlay::ThreadSpecific<trace_buffer> buffers;
+static std::atomic<uint32_t> next_worker{0};
+static std::atomic<uint32_t> current_process{0};
+static std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+static std::mutex process_mutex;
+static std::vector<std::string> process_names;
+
+uint32_t trace_worker() {
+    static thread_local uint32_t id = next_worker++;
+    return id;
+}
+
+double trace_now() {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void trace_record(const char* name, const trace_spawn& spawn, double begin, double end) {
+    buffers->push_back({name, current_process.load(std::memory_order_relaxed), trace_worker(),
+                        spawn.worker, spawn.time, begin, end});
+}
+
+void trace_reset() {
+    buffers.for_each([](trace_buffer& buffer) { buffer.clear(); });
+    std::lock_guard<std::mutex> lock(process_mutex);
+    process_names.clear();
+    current_process = 0;
+    trace_worker();  // the calling thread becomes worker 0 if it is the first
+    epoch = std::chrono::steady_clock::now();
+}
+
+void trace_process(const std::string& name) {
+    std::lock_guard<std::mutex> lock(process_mutex);
+    process_names.push_back(name);
+    current_process = process_names.size();
+}
+
+static std::string json_escape(const std::string& s) {
+    std::string res;
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            res += '\\';
+        }
+        res += c;
+    }
+    return res;
+}
+
+// Process 0 holds events recorded before the first trace_process call.
+void trace_write(std::ostream& out) {
+    std::vector<trace_event> events;
+    buffers.for_each([&](trace_buffer& buffer) { events.insert(events.end(), buffer.begin(), buffer.end()); });
+
+    auto flags = out.flags();
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    const char* separator = "";
+    std::set<std::pair<uint32_t, uint32_t>> rows;
+    for (const trace_event& e : events) {
+        rows.insert({e.process, e.worker});
+        rows.insert({e.process, e.spawner});
+    }
+    {
+        std::lock_guard<std::mutex> lock(process_mutex);
+        for (size_t p = 0; p < process_names.size(); ++p) {
+            out << separator << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << p + 1
+                << ",\"args\":{\"name\":\"" << json_escape(process_names[p]) << "\"}}";
+            separator = ",\n";
+        }
+    }
+    for (auto [process, worker] : rows) {
+        out << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << process << ",\"tid\":" << worker
+            << ",\"args\":{\"name\":\"worker " << worker << "\"}}";
+        separator = ",\n";
+    }
+
+    size_t steals = 0;
+    for (const trace_event& e : events) {
+        bool stolen = e.worker != e.spawner;
+        out << separator << "{\"name\":\"" << e.name << "\",\"cat\":\"task\",\"ph\":\"X\",\"pid\":" << e.process
+            << ",\"tid\":" << e.worker << ",\"ts\":" << e.begin << ",\"dur\":" << e.end - e.begin
+            << ",\"args\":{\"spawned_by\":" << e.spawner << ",\"queued_us\":" << e.begin - e.spawned
+            << ",\"stolen\":" << (stolen ? "true" : "false") << "}}";
+        separator = ",\n";
+
+        if (stolen) {
+            ++steals;
+            out << ",\n{\"name\":\"steal\",\"cat\":\"steal\",\"ph\":\"s\",\"id\":" << steals
+                << ",\"pid\":" << e.process << ",\"tid\":" << e.spawner << ",\"ts\":" << e.spawned << "}"
+                << ",\n{\"name\":\"steal\",\"cat\":\"steal\",\"ph\":\"f\",\"bp\":\"e\",\"id\":" << steals
+                << ",\"pid\":" << e.process << ",\"tid\":" << e.worker << ",\"ts\":" << e.begin << "}";
+        }
+    }
+    out << "\n]}\n";
+    out.flags(flags);
+}
+
+#else
+
+void trace_reset() {}
+void trace_process(const std::string&) {}
+void trace_write(std::ostream& out) {
+    out << "{\"traceEvents\":[]}\n";
+}
+
+#endif